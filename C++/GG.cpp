@@ -1,9 +1,22 @@
 // uses NTL
 //   http://www.shoup.net/ntl
 
-#include "GG.h"
+#include<cmath>
+#include<algorithm>
+#include "GGT.h"
+#include<NTL/BasicThreadPool.h>
 using namespace NTL;
 
+static long MaxBits(const GG& a, const GG& b)
+// number of bits of largest part of a and b
+{
+    long k(NumBits(a.x)), l;
+    if((l = NumBits(a.y)) > k) k = l;
+    if((l = NumBits(b.x)) > k) k = l;
+    if((l = NumBits(b.y)) > k) k = l;
+    return k;
+}
+
 std::ostream& operator<<(std::ostream& s, const GG& a) {// print a as [a.x a.y]
     s << '[' << a.x << ' ' << a.y << ']';
     return s;
@@ -48,6 +61,8 @@ void set(GG& a, long x, long y) { a.x=x; a.y=y; }// a=x+iy
 
 void clear(GG& a) { clear(a.x); clear(a.y); }// a=0
 
+void swap(GG& a, GG& b) { swap(a.x, b.x); swap(a.y, b.y); }// exchange a and b
+
 void conj(GG& b, const GG& a) {// b = complex conjugate of a
     if(&b!=&a) b.x = a.x;
     negate(b.y, a.y);
@@ -264,17 +279,57 @@ long divide2(GG& q, const GG& a)
     return 1;
 }
 
+static void reduce(GG& r, const GG& a, const GGModulus& M);
+
+static long WindowSize(long l)
+{// window size for sliding window exponentiation of l-bit exponent
+    if(l <= 8) return 1;
+    if(l <= 24) return 2;
+    if(l <= 80) return 3;
+    if(l <= 240) return 4;
+    if(l <= 672) return 5;
+    return 6;
+}
+
+static void PowerWin(GG& b, const GG& a, const ZZ& n, const GGModulus* M)
+// b = a^n by sliding window method; assume n>0
+// if M!=0, intermediate results are reduced (not canonically) mod M->m
+{
+    long i,j,k,u,w(WindowSize(NumBits(n)));
+    Vec<GG> t;// odd powers a, a^3, ..., a^(2^w-1)
+    GG c;
+    t.SetLength(1L<<(w-1));
+    t[0] = a;
+    if(w>1) { sqr(c,a); if(M) reduce(c,c,*M); }
+    for(i=1; i<t.length(); i++) {
+        mul(t[i], t[i-1], c);
+        if(M) reduce(t[i], t[i], *M);
+    }
+    for(i=NumBits(n)-1, k=1; i>=0; i=j-1) {
+        if(!bit(n,i)) {
+            sqr(b,b); if(M) reduce(b,b,*M);
+            j=i;
+            continue;
+        }
+        j = i-w+1;
+        if(j<0) j=0;
+        while(!bit(n,j)) j++;
+        for(u=0; i>=j; i--) {
+            u = 2*u + bit(n,i);
+            if(k) continue;
+            sqr(b,b); if(M) reduce(b,b,*M);
+        }
+        if(k) { b = t[u>>1]; k=0; continue; }
+        b *= t[u>>1];
+        if(M) reduce(b,b,*M);
+    }
+}
+
 void power(GG& b, const GG& a, long n)
 // b = a^n; assume n>=0
 {
     if(n==0 || IsOne(a)) { set(b); return; }
-    if(&b==&a) { GG c(a); power(b,c,n); return; }
-    long m(1<<(NumBits(n)-1));
-    b=a;
-    for(m>>=1; m; m>>=1) {
-        sqr(b,b);
-        if(n&m) b*=a;
-    }
+    PowerWin(b, a, ZZ(n), 0);
 }
 
 long IsUnit(const GG& a) {// return 1 if |a|=1 else 0
@@ -293,18 +348,32 @@ long IsAssoc(const GG& a, const GG& b)
     return 0;
 }
 
+template<class T> static void GCD_(GG& d, const GG& a, const GG& b)
+{// GCD on native integers
+    GGT<T> x,y;
+    conv(x,a); conv(y,b);
+    GCD(x,x,y);
+    conv(d,x);
+}
+
 void GCD(GG& d, const GG& a, const GG& b)
 // d = greatest common divisor of a and b
 //   in first quadrant Re(d)>0 and Im(d)>=0
 // by euclidean algorithm
 {
-    GG x(a),y(b),r;
-    while(!IsZero(y)) {
-        rem(r,x,y);
-        x=y;
-        y=r;
-    }
-    FirstQuad(d,x);
+    long l(MaxBits(a,b));
+    if(l <= GGT_LONG_BITS) GCD_<long>(d,a,b);
+    else if(l <= GGT_INT128_BITS) GCD_<__int128>(d,a,b);
+    else LehmerGCD(d,a,b);
+}
+
+template<class T>
+static void XGCD_(GG& d, GG& s, GG& t, const GG& a, const GG& b)
+{// XGCD on native integers
+    GGT<T> x,y,u,v;
+    conv(x,a); conv(y,b);
+    XGCD(x,u,v,x,y);
+    conv(d,x); conv(s,u); conv(t,v);
 }
 
 void XGCD(GG& d, GG& s, GG& t, const GG& a, const GG& b)
@@ -313,26 +382,10 @@ void XGCD(GG& d, GG& s, GG& t, const GG& a, const GG& b)
 //   and compute s,t such that d = s*a + t*b
 // by extended euclidean algorithm
 {
-    long c;
-    GG x(a),y(b),u,v(1),q,r;
-    set(s);
-    clear(t);
-    while(!IsZero(y)) {
-        DivRem(q,r,x,y);
-        mul(x,q,u);
-        sub(x,s,x);
-        s=u;
-        u=x;
-        mul(x,q,v);
-        sub(x,t,x);
-        t=v;
-        v=x;
-        x=y;
-        y=r;
-    }
-    c = FirstQuad(d,x);
-    mul_i(s,s,c);
-    mul_i(t,t,c);
+    long l(MaxBits(a,b));
+    if(l <= GGT_LONG_BITS) XGCD_<long>(d,s,t,a,b);
+    else if(l <= GGT_INT128_BITS) XGCD_<__int128>(d,s,t,a,b);
+    else LehmerXGCD(d,s,t,a,b);
 }
 
 // a = random gaussian integer in square [-L,L]^2
@@ -345,31 +398,180 @@ void RandomLen(GG& a, long l)// 2^{l-1} <= L < 2^l
 void RandomBnd(GG& a, const ZZ& n)// 0 <= L < n
 { RandomBnd(a.x, n); RandomBnd(a.y, n); mul_i(a, a, RandomBits_long(2)); }
 
+template<class T, class E>
+static void PowerMod_(GG& b, const GG& a, const E& n, const GG& m)
+{// PowerMod on native integers
+    GGT<T> x,y;
+    conv(x,a); conv(y,m);
+    PowerMod(x,x,n,y);
+    conv(b,x);
+}
+
 void PowerMod(GG& b, const GG& a, long n, const GG& m)
 // b = a^n mod m; assume n>=0 and |a| < |m|
 {
     if(n==0 || IsOne(a)) { set(b); return; }
-    if(&b==&a) { GG c(a); PowerMod(b,c,n,m); return; }
-    long k(1<<(NumBits(n)-1));
-    b=a;
-    for(k>>=1; k; k>>=1) {
-        sqr(b,b); b%=m;
-        if(n&k) { b*=a; b%=m; }
-    }
+    long l(MaxBits(a,m));
+    if(l <= GGT_LONG_PMBITS) PowerMod_<long>(b,a,n,m);
+    else if(l <= GGT_INT128_PMBITS) PowerMod_<__int128>(b,a,n,m);
+    else PowerMod(b,a,n,GGModulus(m));
 }
 
 void PowerMod(GG& b, const GG& a, const ZZ& n, const GG& m)
 // b = a^n mod m; assume n>=0 and |a| < |m|
 {
     if(IsZero(n) || IsOne(a)) { set(b); return; }
-    if(&b==&a) { GG c(a); PowerMod(b,c,n,m); return; }
-    b=a;
-    for(long k=NumBits(n)-2; k>=0; k--) {
-        sqr(b,b); b%=m;
-        if(bit(n,k)) { b*=a; b%=m; }
+    long l(MaxBits(a,m));
+    if(l <= GGT_LONG_PMBITS) PowerMod_<long>(b,a,n,m);
+    else if(l <= GGT_INT128_PMBITS) PowerMod_<__int128>(b,a,n,m);
+    else PowerMod(b,a,n,GGModulus(m));
+}
+
+GGModulus::GGModulus(const GG& m, long prime) { build(*this, m, prime); }
+
+void build(GGModulus& M, const GG& m, long prime)
+// precompute norm, conjugate and reciprocal of m
+{
+    ZZ t,u;
+    if(IsZero(m)) Error("zero modulus in GGModulus");
+    M.m = m;
+    M.prime = prime;
+    conj(M.c, m);
+    norm(M.n, m);
+    M.s = 2*MaxBits(m,m) + 4;
+    LeftShift(u, M.n, 1);// w = round(2^s * conj(m)/norm(m))
+    LeftShift(t, M.c.x, M.s+1); t += M.n; div(M.w.x, t, u);
+    LeftShift(t, M.c.y, M.s+1); t += M.n; div(M.w.y, t, u);
+}
+
+static void RoundShift(ZZ& a, long s)
+{// a = floor(a/2^s + 1/2)
+    a += power2_ZZ(s-1);
+    if(sign(a) >= 0) { a >>= s; return; }
+    negate(a,a);
+    a += power2_ZZ(s) - 1;
+    a >>= s;
+    negate(a,a);
+}
+
+static void reduce(GG& r, const GG& a, const GGModulus& M)
+// r == a (mod m) such that |r| < |m|, by barrett reduction
+// Assume |Re(a)|,|Im(a)| < 2^(s-2)
+{
+    GG q;
+    mul(q, a, M.w);
+    RoundShift(q.x, M.s);
+    RoundShift(q.y, M.s);
+    mul(q, q, M.m);
+    sub(r, a, q);
+}
+
+void rem(GG& r, const GG& a, const GGModulus& M)
+// r = remainder of a/m (same as rem(r,a,m))
+{
+    GG q;
+    ZZ u;
+    if(MaxBits(a,a) <= M.s-2) reduce(r,a,M);
+    else r = a;
+    mul(q, r, M.c);
+    LeftShift(u, M.n, 1);
+    q.x <<= 1; q.x += M.n; div(q.x, q.x, u);
+    q.y <<= 1; q.y += M.n; div(q.y, q.y, u);
+    if(IsZero(q)) return;
+    mul(q, q, M.m);
+    sub(r, r, q);
+}
+
+void MulMod(GG& c, const GG& a, const GG& b, const GGModulus& M)
+{ mul(c,a,b); rem(c,c,M); }// c = a*b mod m
+
+void SqrMod(GG& b, const GG& a, const GGModulus& M)
+{ sqr(b,a); rem(b,b,M); }// b = a*a mod m
+
+void PowerMod(GG& b, const GG& a, long n, const GGModulus& M)
+// b = a^n mod m; assume n>=0
+{
+    if(n < 0) Error("negative exponent in PowerMod");
+    PowerMod(b, a, ZZ(n), M);
+}
+
+void PowerMod(GG& b, const GG& a, const ZZ& n, const GGModulus& M)
+// b = a^n mod m; assume n>=0
+{
+    if(IsZero(n) || IsOne(a)) { set(b); return; }
+    if(M.prime) { PowerModPrime(b,a,n,M); return; }
+    GG c;
+    rem(c,a,M);
+    PowerWin(b,c,n,&M);
+    rem(b,b,M);
+}
+
+void build(GGPowerTable& T, const GG& a, const GGModulus& M, long l)
+// T.t[k] = a^(2^(w*k)) mod m for k*w < l
+//   with w chosen to minimize l/w + 2^w
+{
+    long k;
+    if(l<1) l=1;
+    for(k=1; (l+k)/(k+1) + (2L<<k) < (l+k-1)/k + (1L<<k); k++);
+    T.m = M;
+    T.w = k;
+    T.t.SetLength((l+k-1)/k);
+    rem(T.t[0], a, M);
+    for(k=1; k<T.t.length(); k++) {
+        T.t[k] = T.t[k-1];
+        for(long i=0; i<T.w; i++) { sqr(T.t[k], T.t[k]); reduce(T.t[k], T.t[k], M); }
     }
 }
 
+void PowerMod(GG& b, const GGPowerTable& T, const ZZ& n)
+// b = a^n mod m by fixed base windowing (yao's method)
+// assume n>=0
+{
+    long i,j,k,e(0),l(T.t.length()),w(T.w);
+    Vec<long> d;// base 2^w digits of n
+    GG c;// e==0 until c has a factor (c may be 0 mod composite m)
+    if(IsZero(n)) { set(b); return; }
+    if(NumBits(n) > l*w) {// exponent too long for table
+        PowerMod(b, T.t[0], n, T.m);
+        return;
+    }
+    d.SetLength(l);
+    for(k=0; k<l; k++)
+        for(i=w-1, d[k]=0; i>=0; i--) d[k] = 2*d[k] + bit(n, k*w+i);
+    set(b);
+    for(j=(1L<<w)-1; j>0; j--) {// b = prod_j (prod_{d[k]>=j} t[k])
+        for(k=0; k<l; k++) {
+            if(d[k]!=j) continue;
+            if(!e) { c = T.t[k]; e = 1; }
+            else { c *= T.t[k]; reduce(c,c,T.m); }
+        }
+        if(!e) continue;
+        b *= c;
+        reduce(b,b,T.m);
+    }
+    rem(b,b,T.m);
+}
+
+long divide(GG& q, const GG& a, const GGModulus& M)
+// if a/m is divisible, set q=a/m and return 1
+// else return 0 (and q is unchanged)
+{
+    GG c;
+    mul(c, a, M.c);
+    if(!divide(c.x, c.x, M.n) ||
+       !divide(q.y, c.y, M.n)) return 0;
+    q.x = c.x;
+    return 1;
+}
+
+long divide(const GG& a, const GGModulus& M)
+// if a/m is divisible, return 1, else return 0
+{
+    GG c;
+    mul(c, a, M.c);
+    return divide(c.x, M.n) && divide(c.y, M.n);
+}
+
 long ProbPrime(const GG& a, long NTRY)
 // test if a is gaussian prime, i.e., return 1 if either
 //   |a| is prime and |a|==3 (mod 4) or
@@ -387,6 +589,78 @@ long ProbPrime(const GG& a, long NTRY)
     return b==2 || trunc_long(b,2)==1 && ProbPrime(b, NTRY);
 }
 
+#define GENPRIME_SIEVE (1L<<14) // largest prime of sieve
+#define GENPRIME_WIN 64 // least number of candidates in sieve window
+
+struct GenPrimeTable {// odd primes up to GENPRIME_SIEVE and 1/4 mod them
+    Vec<long> p,v;
+    GenPrimeTable() {
+        long q;
+        PrimeSeq ps;
+        ps.next();// skip 2
+        while((q = ps.next()) <= GENPRIME_SIEVE) {
+            p.append(q);
+            v.append(InvMod(4%q, q));
+        }
+    }
+};
+
+static const GenPrimeTable& SievePrimes()
+{// built once on first call
+    static GenPrimeTable T;
+    return T;
+}
+
+static long NumTrials(long l, long err)
+// number of rounds of miller-rabin such that
+//   a random l-bit composite passes all of them
+//   with probability less than 2^-err
+// by bounds of Damgard, Landrock and Pomerance (1993)
+{
+    long t;
+    double k(l), lk(log2(k));
+    for(t=1;; t++) {
+        if(2*t >= err + lk) return t;
+        if(k<21) continue;
+        if(t==1 && 2*lk + 4 - 2*sqrt(k) <= -err) return t;
+        if(t>=3 && 9*t <= k && 1.5*lk + t - 0.5*log2(t) + 4 - 2*sqrt(t*k) <= -err) return t;
+    }
+}
+
+static void GenPrime_(ZZ& q, long l, long c, long t)
+// q = random prime such that 2^{l-1} <= q < 2^l and q==c (mod 4)
+//   by incremental search q0, q0+4, q0+8, ... from random q0
+// windows of candidates are sieved by odd primes up to min(16l, GENPRIME_SIEVE)
+//   and survivors are tested by t rounds of miller-rabin
+// assume l>=3
+{
+    const GenPrimeTable& T(SievePrimes());
+    long i,j,p,r,w(std::max(l, long(GENPRIME_WIN))),B(std::min(16*l, GENPRIME_SIEVE));
+    ZZ b,u;
+    Vec<char> s;
+    s.SetLength(w);
+    power2(b,l);
+    for(;;) {
+        RandomLen(q,l);
+        q += (c - trunc_long(q,2))&3;
+        for(; q<b; q += 4*w) {
+            for(j=0; j<w; j++) s[j] = 1;
+            for(i=0; i<T.p.length() && (p = T.p[i]) <= B; i++) {
+                r = rem(q,p);
+                j = (r ? MulMod(p-r, T.v[i], p) : 0);// q+4j == 0 (mod p)
+                if(q<=p && to_long(q) + 4*j == p) j += p;// q+4j is p itself
+                for(; j<w; j+=p) s[j] = 0;
+            }
+            for(j=0; j<w; j++) {
+                if(!s[j]) continue;
+                add(u, q, 4*j);
+                if(u>=b) break;
+                if(ProbPrime(u,t)) { q = u; return; }
+            }
+        }
+    }
+}
+
 void GenPrime(GG& p, long l, long f, long err)
 // generate random gaussian prime p.
 // f must be 1 or 2; l must be l>=2
@@ -395,24 +669,47 @@ void GenPrime(GG& p, long l, long f, long err)
 // where q is random prime and 2^{l-1} <= q < 2^l
 // probability of error is less than 2^-err
 // p=x+iy is primary (x odd, y even, x+y==1 (mod 4))
+// q is drawn in its residue class by GenPrime_
 {
     if(l<2) Error("l<2 in GenPrime");
     ZZ q;
+    if(l==2) {// q = 2 or 3
+        if(f<=1) set(p,1,1);
+        else set(p,-3,0);
+        return;
+    }
+    GenPrime_(q, l, (f<=1 ? 1 : 3), NumTrials(l, err));
     if(f<=1) {
-        do GenPrime(q,l,err);
-        while(trunc_long(q,2)==3);
-        if(q==2) { set(p,1,1); return; }
         FactorPrime(p,q);
         if(RandomBits_long(1)) conj(p,p);
     }
     else {
-        do GenPrime(q,l,err);
-        while(trunc_long(q,2)!=3);
         negate(p.x, q);
-        clear(p.y);        
+        clear(p.y);
     }
 }
 
+void GenPrimes(Vec<GG>& p, long n, long l, long f, long err)
+// p[k] = GenPrime(p[k],l,f,err) for k=0,...,n-1
+//   distributed over NTL's thread pool
+// each p[k] is generated by its own random stream
+//   seeded from current stream of caller
+//   so that p does not depend on number of threads
+{
+    long k;
+    Vec<ZZ> s;
+    s.SetLength(n);
+    for(k=0; k<n; k++) RandomBits(s[k], 256);
+    p.SetLength(n);
+    NTL_EXEC_RANGE(n, first, last)
+        RandomStreamPush push;
+        for(long i=first; i<last; i++) {
+            SetSeed(s[i]);
+            GenPrime(p[i], l, f, err);
+        }
+    NTL_EXEC_RANGE_END
+}
+
 long primary(GG& b, const GG& a)
 // b = unit * a = x+iy such that
 //   x==1 and y==0 or x==3 and y==2 (mod 4)
@@ -434,17 +731,38 @@ long primary(GG& b, const GG& a)
     return 0;
 }
 
-void ResSymb(GG& s, const GG& a, const GG& b)
-// s = biquadratic residue symbol (a/b)_4 = 0,1,i,-1,-i
-// Assume |a| < |b| and |b|^2 is odd
-// Assume b is primary, but may not be prime
-// reference: K. S. Williams
-//   "On the Supplement to the Law of Biquadratic Reciprocity"
-//   Proceedings of the American Mathematical Society 59 (1976) 19
+template<class T> static void ResSymb_(GG& s, const GG& a, const GG& b)
+{// ResSymb on native integers
+    GGT<T> x,y;
+    conv(x,a); conv(y,b);
+    ResSymb(x,x,y);
+    conv(s,x);
+}
+
+static void SetSymb(GG& s, long j)
+{// s = i^j if j>=0, else s=0
+    if(j<0) clear(s);
+    else if(j==0) set(s);
+    else if(j==1) set(s,0,1);
+    else if(j==2) conv(s,-1);
+    else set(s,0,-1);
+}
+
+static long ResSymbLoop(const GG& a, const GG& b, GG& u, GG& v, GG& w)
+// return j such that (a/b)_4 = i^j, or -1 if (a/b)_4 = 0
+// u,v,w are scratch space
 {
     long j(0),k,m,n;
-    GG u(a),v(b),w;
+    GGT<__int128> x,y;
+    u = a;
+    v = b;
     while(!IsZero(u)) {
+        if(MaxBits(u,v) <= GGT_INT128_BITS) {// finish on native integers
+            conv(x,u); conv(y,v);
+            ResSymb(x,x,y);
+            if(IsZero(x)) return -1;
+            return (j + (x.x==1 ? 0 : x.y==1 ? 1 : x.x==-1 ? 2 : 3))&3;
+        }
         m = trunc_long(v.x, 4);// m odd
         n = trunc_long(v.y, 4);// n even
         if(sign(v.x) < 0) m = -m;
@@ -459,12 +777,196 @@ void ResSymb(GG& s, const GG& a, const GG& b)
         j &= 3;
         
         rem(w,v,u);
-        v = u;
-        u = w;
+        swap(v,u);
+        swap(u,w);
     }
-    if(!IsUnit(v)) clear(s);
-    else if(j==0) set(s);
-    else if(j==1) set(s,0,1);
-    else if(j==2) conv(s,-1);
-    else set(s,0,-1);
+    return IsUnit(v) ? j : -1;
+}
+
+void ResSymb(GG& s, const GG& a, const GG& b)
+// s = biquadratic residue symbol (a/b)_4 = 0,1,i,-1,-i
+// Assume |a| < |b| and |b|^2 is odd
+// Assume b is primary, but may not be prime
+// reference: K. S. Williams
+//   "On the Supplement to the Law of Biquadratic Reciprocity"
+//   Proceedings of the American Mathematical Society 59 (1976) 19
+{
+    long k;
+    if((k = MaxBits(a,b)) <= GGT_LONG_BITS) { ResSymb_<long>(s,a,b); return; }
+    if(k <= GGT_INT128_BITS) { ResSymb_<__int128>(s,a,b); return; }
+    GG u,v,w;
+    SetSymb(s, ResSymbLoop(a,b,u,v,w));
+}
+
+#define BINSYMB_LONG_BITS 62 // native binary steps if |x|,|y| < 2^this
+
+static long Twos(const GGT<long>& a)
+{// largest t such that 2^t divides a; assume a!=0
+    return __builtin_ctzl(a.x | a.y);
+}
+
+static long Twos(const GGT<ZZ>& a)
+{// largest t such that 2^t divides a; assume a!=0
+    if(IsZero(a.x)) return NumTwos(a.y);
+    if(IsZero(a.y)) return NumTwos(a.x);
+    long s(NumTwos(a.x)), t(NumTwos(a.y));
+    return s<t ? s:t;
+}
+
+static long Less(const GGT<long>& a, const GGT<long>& b)
+{// test if |a| < |b|
+    return (__int128)a.x*a.x + (__int128)a.y*a.y
+         < (__int128)b.x*b.x + (__int128)b.y*b.y;
+}
+
+static long Less(const GGT<ZZ>& a, const GGT<ZZ>& b)
+{// test if |a| < |b| approximately by leading 62 bits
+    long k(NumBits(a.x)),l;
+    if((l = NumBits(a.y)) > k) k = l;
+    if((l = NumBits(b.x)) > k) k = l;
+    if((l = NumBits(b.y)) > k) k = l;
+    if((k -= 62) < 0) k = 0;
+    __int128 x(to_long(RightShift(a.x, k))), y(to_long(RightShift(a.y, k)));
+    __int128 u(to_long(RightShift(b.x, k))), v(to_long(RightShift(b.y, k)));
+    return x*x + y*y < u*u + v*v;
+}
+
+static long Small(const GGT<long>&, const GGT<long>&) { return 0; }
+
+static long Small(const GGT<ZZ>& a, const GGT<ZZ>& b)
+{// test if a,b fit in GGT<long> for binary steps
+    return NumBits(a.x) <= BINSYMB_LONG_BITS && NumBits(a.y) <= BINSYMB_LONG_BITS
+        && NumBits(b.x) <= BINSYMB_LONG_BITS && NumBits(b.y) <= BINSYMB_LONG_BITS;
+}
+
+template<class T> static long BinResSymb_(GGT<T>& u, GGT<T>& v, long& j)
+// binary steps keeping i^j * (u/v)_4 invariant
+// return k such that i^j * (u/v)_4 = i^k, or -1 if it is 0,
+//   or -2 if u,v get small enough for GGT<long>
+// Assume v is primary
+{
+    long k,m,n,t;
+    for(;;) {
+        if(IsZero(u)) return IsUnit(v) ? j&3 : -1;
+        m = Mod16(v.x);// m odd
+        n = Mod16(v.y);// n even
+        k = (m-n)>>2;
+        if(n &= 2) k--;
+        m >>= 1; m &= 3; k &= 3;
+
+        t = Twos(u);// 2 = -i(1+i)^2
+        u.x >>= t; u.y >>= t; j += t*(2*k+m);
+        if(divide2(u,u)) j += k;// supplementary law for 1+i
+        if(t = primary(u,u)) j -= t*m;// supplementary law for units
+        j &= 3;
+        if(IsOne(u)) return j;
+        if(Less(u,v)) {
+            if(n && (Mod16(u.y)&2)) j += 2;// reciprocity
+            swap(u,v);
+        }
+        sub(u,u,v);// divisible by (1+i)^3
+        if(Small(u,v)) return -2;
+    }
+}
+
+void BinResSymb(GG& s, const GG& a, const GG& b)
+// s = biquadratic residue symbol (a/b)_4 = 0,1,i,-1,-i
+//   by binary algorithm with shifts, additions and subtractions
+// same assumptions as ResSymb
+{
+    long j(0),k(-2);
+    GGT<long> x,y;
+    if(MaxBits(a,b) > BINSYMB_LONG_BITS) {
+        GGT<ZZ> u,v;
+        conv(u,a); conv(v,b);
+        if((k = BinResSymb_(u,v,j)) == -2) {
+            x.x = to_long(u.x); x.y = to_long(u.y);
+            y.x = to_long(v.x); y.y = to_long(v.y);
+        }
+    }
+    else {
+        x.x = to_long(a.x); x.y = to_long(a.y);
+        y.x = to_long(b.x); y.y = to_long(b.y);
+    }
+    if(k == -2) k = BinResSymb_(x,y,j);
+    SetSymb(s,k);
+}
+
+#define RESSYMB_TABLE_BITS 22 // largest norm for lookup table
+#define RESSYMB_TABLE_MIN 16 // use table if batch size >= norm/this
+
+static long ResSymbChar(long& r, const GG& b)
+// if norm(b) is prime p < 2^NTL_SP_NBITS, set r = i mod b in [0,p)
+//   and return p, else return 0
+{
+    ZZ n;
+    norm(n,b);
+    if(NumBits(n) > NTL_SP_NBITS || IsZero(b.x) || IsZero(b.y)) return 0;
+    if(!ProbPrime(n)) return 0;
+    long p(to_long(n));
+    r = MulMod(rem(b.x,p), InvMod(rem(b.y,p), p), p);
+    if(r) r = p-r;// b = x+iy == 0 so i == -x/y
+    return p;
+}
+
+static long ResSymbChar(const GG& a, long p, long r)
+// return j such that (a/b)_4 = i^j, or -1 if zero
+//   by euler criterion (a/b)_4 == a^((p-1)/4) (mod b)
+// where p = norm(b) is prime and i == r (mod b)
+{
+    long t(AddMod(rem(a.x,p), MulMod(rem(a.y,p), r, p), p));
+    if(t==0) return -1;
+    t = PowerMod(t, p>>2, p);
+    if(t==1) return 0;
+    if(t==r) return 1;
+    if(t==p-1) return 2;
+    return 3;
+}
+
+static void ResSymbTable(Vec<signed char>& T, long p, long r)
+// T[t] = j such that (t/b)_4 = i^j for t in F_p, T[0]=-1
+// where p = norm(b) is prime and i == r (mod b)
+{
+    long g,h,j,k,q,m(p-1);
+    Vec<long> f;// prime factors of p-1
+    for(q=2; q*q<=m; q++) {
+        if(m%q) continue;
+        f.append(q);
+        while(m%q==0) m/=q;
+    }
+    if(m>1) f.append(m);
+    for(g=2;; g++) {// primitive root
+        for(k=0; k<f.length(); k++)
+            if(PowerMod(g, (p-1)/f[k], p)==1) break;
+        if(k==f.length()) break;
+    }
+    h = PowerMod(g, p>>2, p);
+    j = (h==r ? 1 : 3);// (g/b)_4 = i^j
+    T.SetLength(p);
+    T[0] = -1;
+    for(k=0, h=1; k<p-1; k++, h=MulMod(h,g,p))
+        T[h] = (k*j)&3;
+}
+
+void ResSymbBatch(Vec<GG>& s, const Vec<GG>& a, const GG& b)
+// s[k] = (a[k]/b)_4 for all k
+// same assumptions as ResSymb on each a[k]
+{
+    long n(a.length()),p,r;
+    Vec<signed char> T;
+    s.SetLength(n);
+    if(n==0) return;
+    if((p = ResSymbChar(r,b)) &&
+       NumBits(p) <= RESSYMB_TABLE_BITS && n >= p/RESSYMB_TABLE_MIN)
+        ResSymbTable(T,p,r);
+
+    NTL_EXEC_RANGE(n, first, last)
+        GG u,v,w;
+        for(long k=first; k<last; k++) {
+            if(T.length()) SetSymb(s[k], T[AddMod(rem(a[k].x,p), MulMod(rem(a[k].y,p), r, p), p)]);
+            else if(p) SetSymb(s[k], ResSymbChar(a[k],p,r));
+            else if(MaxBits(a[k],b) <= GGT_INT128_BITS) ResSymb(s[k],a[k],b);
+            else SetSymb(s[k], ResSymbLoop(a[k],b,u,v,w));
+        }
+    NTL_EXEC_RANGE_END
 }
\ No newline at end of file
@@ -4,7 +4,9 @@
 #ifndef __GG_h__
 #define __GG_h__
 
+#include<functional>
 #include<NTL/ZZ.h>
+#include<NTL/vector.h>
 
 struct GG {// Gaussian integer x+iy
     NTL::ZZ x,y;// real and imaginary part
@@ -46,6 +48,7 @@ void set(GG& a); // a=1
 void set(GG& a, const NTL::ZZ& x, const NTL::ZZ& y);// a=x+iy
 void set(GG& a, long x, long y);// a=x+iy
 void clear(GG& a);// a=0
+void swap(GG& a, GG& b);// exchange a and b
 void conj(GG& b, const GG& a);// b = x-iy when a==x+iy
 void mirror(GG& b, const GG& a);// b = y+ix
 void norm(NTL::ZZ& n, const GG& a);// n = x**2 + y**2
@@ -113,6 +116,13 @@ void XGCD(GG&, GG&, GG&, const GG&, const GG&);
 //   and compute s,t such that d = s*a + t*b
 // by extended euclidean algorithm
 
+void LehmerGCD(GG& d, const GG& a, const GG& b);
+void LehmerXGCD(GG& d, GG& s, GG& t, const GG& a, const GG& b);
+// same as GCD and XGCD
+// by Lehmer's algorithm on leading words of a and b
+//   and recursive half-gcd for long operands
+// GCD and XGCD call these if a or b does not fit in GGT<__int128>
+
 // a = random gaussian integer in square [-L,L]^2
 void RandomBits(GG& a, long l);// 0 <= L < 2^l
 void RandomLen(GG& a, long l);// 2^{l-1} <= L < 2^l
@@ -122,6 +132,53 @@ void PowerMod(GG& b, const GG& a, long n, const GG& m);
 void PowerMod(GG& b, const GG& a, const NTL::ZZ& n, const GG& m);
 // b = a^n mod m; assume n>=0 and |a| < |m|
 
+struct GGModulus {// precomputed data for reduction modulo m
+    GG m;// modulus
+    GG c;// conj(m)
+    NTL::ZZ n;// norm(m)
+    GG w;// round(2^s/m)
+    long s;// 2*(bits of max(|Re(m)|,|Im(m)|)) + 4
+    long prime;// nonzero if m is known to be prime
+    GGModulus() : prime(0) {;}
+    explicit GGModulus(const GG& m, long prime=0);
+};
+
+void build(GGModulus& M, const GG& m, long prime=0);
+// precompute norm, conjugate and reciprocal of m
+// intermediate products are reduced by barrett reduction
+// if prime!=0, m must be gaussian prime,
+//   and PowerMod uses PowerModPrime
+
+void rem(GG& r, const GG& a, const GGModulus& m);// r = a mod m
+void MulMod(GG& c, const GG& a, const GG& b, const GGModulus& m);// c = a*b mod m
+void SqrMod(GG& b, const GG& a, const GGModulus& m);// b = a*a mod m
+void PowerMod(GG& b, const GG& a, long n, const GGModulus& m);
+void PowerMod(GG& b, const GG& a, const NTL::ZZ& n, const GGModulus& m);
+// b = a^n mod m; assume n>=0
+// results are reduced as rem(r,a,m.m)
+
+void PowerModPrime(GG& b, const GG& a, const NTL::ZZ& n, const GGModulus& p);
+// b = a^n mod p; assume n>=0 and p is gaussian prime
+// by isomorphism Z[i]/(p) == ZZ_p (norm(p) prime)
+//   or ZZ_pE = ZZ_p[i]/(i^2+1) (norm(p) = q^2, q==3 mod 4)
+
+struct GGPowerTable {// powers of fixed base a modulo m
+    GGModulus m;// modulus
+    NTL::Vec<GG> t;// t[k] = a^(2^(w*k)) mod m
+    long w;// window size in bits
+};
+
+void build(GGPowerTable& T, const GG& a, const GGModulus& m, long l);
+// precompute T for base a and exponents of at most l bits
+void PowerMod(GG& b, const GGPowerTable& T, const NTL::ZZ& n);
+// b = a^n mod m using T; assume n>=0
+// costs about l/w + 2^w multiplications and no squarings
+// falls back to PowerMod(b,a,n,m) if n is longer than l bits
+
+long divide(GG& q, const GG& a, const GGModulus& m);
+long divide(const GG& a, const GGModulus& m);
+// same as divide(q,a,m.m) and divide(a,m.m)
+
 long ProbPrime(const GG& a, long NTRY=10);
 // test if a is gaussian prime, i.e., return 1 if either
 //   |a| is prime and |a|==3 (mod 4) or
@@ -138,6 +195,29 @@ void GenPrime(GG& p, long l, long f=1, long err=80);
 // where q is random prime and 2^{l-1} <= q < 2^l
 // probability of error is less than 2^-err
 // p=x+iy is primary (x odd, y even, x+y==1 (mod 4))
+// q is found by incremental search in its residue class mod 4
+//   from random start with sieve of small primes
+
+void GenPrimes(NTL::Vec<GG>& p, long n, long l, long f=1, long err=80);
+// p = vector of n random gaussian primes as GenPrime(p[k],l,f,err)
+// elements are distributed over NTL's thread pool
+//   each generated by its own random stream seeded from current stream
+//   so that p does not depend on number of threads
+
+void GaussianPrimes(NTL::Vec<GG>& p, const NTL::ZZ& lo, const NTL::ZZ& hi);
+// p = all gaussian primes with lo <= |p|^2 < hi
+//   in increasing order of norm, one per class of associates:
+//   1+i, primary x+iy and x-iy (y>0) for |p|^2 == 1 (mod 4),
+//   -q for |p|^2 = q^2 and q==3 (mod 4)
+// assume 0 <= lo and hi < 2^62
+// by segmented sieve on wheel of 30 and cornacchia in single words
+//   segments are distributed over NTL's thread pool
+
+void GaussianPrimes(const NTL::ZZ& lo, const NTL::ZZ& hi,
+                    const std::function<void(const NTL::Vec<GG>&)>& f);
+// same as above but call f(p) with gaussian primes p
+//   of consecutive segments of [lo,hi) in increasing order
+//   so that no more than a few segments are held in memory
 
 long primary(GG& b, const GG& a);
 // b = unit * a = x+iy such that
@@ -150,11 +230,31 @@ void ResSymb(GG& s, const GG& a, const GG& b);
 // Assume |a| < |b| and |b|^2 is odd
 // Assume b is primary, but may not be prime
 
+void BinResSymb(GG& s, const GG& a, const GG& b);
+// same as ResSymb(s,a,b) by binary algorithm
+//   using only shifts, additions and subtractions
+//   and native long integers once |Re|,|Im| < 2^62
+
+void ResSymbBatch(NTL::Vec<GG>& s, const NTL::Vec<GG>& a, const GG& b);
+// s[k] = (a[k]/b)_4 for k=0,...,a.length()-1
+// same assumptions as ResSymb for each a[k]
+// elements are distributed over NTL's thread pool
+// if norm(b) is prime < 2^NTL_SP_NBITS, use euler criterion in F_norm(b)
+//   or a table of quartic characters for small norm and large batch
+
 void FactorPrime(GG& a, const NTL::ZZ& p);
 // given a prime number p where p==1 (mod 4),
 // find x,y such that x^2 + y^2 = p
 //   by cornacchia algorithm
 // and return a = primary(x+yi)
+// in single or double words if p < 2^127
+
+void FactorPrime(long& x, long& y, long p);
+// same as FactorPrime(a,p) in single words; assume p < 2^63
+
+void FactorPrime(NTL::Vec<GG>& a, const NTL::Vec<NTL::ZZ>& p);
+// a[k] = FactorPrime(a[k], p[k]) for k=0,...,p.length()-1
+// elements are distributed over NTL's thread pool
 
 void QrtRootMod(GG& x, const GG& a, const GG& p);
 // solve x^4 == a (mod p)
@@ -163,4 +263,7 @@ void QrtRootMod(GG& x, const GG& a, const GG& p);
 //   norm(p) is prime and norm(p)==1 (mod 4)
 //   or norm(p) is prime^2 and p==3 (mod 4)
 
+void QrtRootMod(GG& x, const GG& a, const GGModulus& p);
+// same as QrtRootMod(x,a,p.m)
+
 #endif // __GG_h__
@@ -1,19 +1,66 @@
 // uses NTL
 //   http://www.shoup.net/ntl
 
+#include<mutex>
+#include<unordered_map>
+#include<NTL/BasicThreadPool.h>
 #include "GGFactoring.h"
+#include "GGTable.h"
+#include "Mont.h"
 using namespace NTL;
 
+#define SPLIT_CACHE (1L<<16) // max number of split primes in cache
+#define PAR_BITS 64 // factor content and norm concurrently if both are longer
+
+template<class M> static void FactorPrime_(typename M::T& x, typename M::T& y,
+                                          typename M::T p, typename M::T s)
+// x^2 + y^2 = p where p==1 (mod 4) is prime and s = floor(sqrt(p))
+//   by cornacchia algorithm in single or double words
+{
+    typedef typename M::T T;
+    M P(p);
+    T c,r,m(p - P.one);// -1 in montgomery form
+    for(c=2;; c++) {// r = c^((p-1)/4) is sqrt(-1) if c is not square
+        r = P.power(P.to(c), (p-1)>>2);
+        if(P.mul(r,r) == m) break;
+    }
+    x = p;
+    y = P.from(r);
+    while(x>s) {
+        r = x%y;
+        x = y;
+        y = r;
+    }
+}
+
 void FactorPrime(GG& f, const ZZ& p)
 // given a prime number p where p==1 (mod 4),
 // find x,y such that x^2 + y^2 = p and
 //   x odd, y even, x+y==1(mod 4)
 // return f = x+iy
+// in single or double words if p < 2^127
 // reference: H. Wada
 //   "Prime Factorization by Computers" (in Japanese) p69
 {
     ZZ s,r, &x(f.x), &y(f.y);
+    if(NumBits(p) < 64) {
+        long a,b;
+        FactorPrime(a, b, to_long(p));
+        conv(x,a);
+        conv(y,b);
+        return;
+    }
     SqrRoot(s,p);
+    if(NumBits(p) < 128) {
+        u128 a,b,q,t;
+        conv(q,p);
+        conv(t,s);
+        FactorPrime_<Mont128>(a,b,q,t);
+        conv(x,a);
+        conv(y,b);
+        primary(f,f);
+        return;
+    }
     sub(r,x=p,1);
     SqrRootMod(y,r,p);
     while(x>s) {
@@ -24,6 +71,73 @@ void FactorPrime(GG& f, const ZZ& p)
     primary(f,f);
 }
 
+void FactorPrime(long& x, long& y, long p)
+// same as FactorPrime(f,p) in single words; assume p < 2^63
+// looked up in table if opened by OpenGGTable
+{
+    unsigned long a,b;
+    if(LookupPrime(x,y,p)) return;
+    FactorPrime_<Mont64>(a, b, p, SqrRoot(p));
+    if(a&1) { x=a; y=b; }
+    else { x=b; y=-long(a); }// (a+bi)/i
+    if(((x+y)&3) != 1) { x=-x; y=-y; }// primary
+}
+
+void FactorPrime(Vec<GG>& f, const Vec<ZZ>& p)
+// f[k] = FactorPrime(f[k], p[k]) for all k
+//   distributed over NTL's thread pool
+{
+    f.SetLength(p.length());
+    NTL_EXEC_RANGE(p.length(), first, last)
+        for(long k=first; k<last; k++) FactorPrime(f[k], p[k]);
+    NTL_EXEC_RANGE_END
+}
+
+static void SplitPrime(GG& f, const ZZ& p)
+// f = FactorPrime(f,p) from table or cache if p < 2^63
+//   the cache is cleared when it has SPLIT_CACHE primes
+{
+    static std::mutex mu;
+    static std::unordered_map<long, std::pair<long,long> > c;
+    long q,x,y;
+    if(NumBits(p) >= 64) { FactorPrime(f,p); return; }
+    q = to_long(p);
+    if(LookupPrime(x,y,q)) {
+        conv(f.x, x);
+        conv(f.y, y);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lk(mu);
+        std::unordered_map<long, std::pair<long,long> >::iterator i(c.find(q));
+        if(i!=c.end()) {
+            conv(f.x, i->second.first);
+            conv(f.y, i->second.second);
+            return;
+        }
+    }
+    FactorPrime(f,p);
+    std::lock_guard<std::mutex> lk(mu);
+    if(c.size() >= SPLIT_CACHE) c.clear();
+    c[q] = std::make_pair(to_long(f.x), to_long(f.y));
+}
+
+static long divisible(const GG& b, const GG& q, const ZZ& p)
+// return 1 if q = x+iy divides b, 0 if not
+// Assume q is prime and |q|^2 = p == 1 (mod 4)
+//   then q|b iff Re(b)*y == Im(b)*x (mod p)
+{
+    if(NumBits(p) <= NTL_SP_NBITS) {
+        long P(to_long(p));
+        return MulMod(rem(b.x,P), rem(q.y,P), P) == MulMod(rem(b.y,P), rem(q.x,P), P);
+    }
+    ZZ s,t;
+    rem(s, b.x, p); s *= q.y;
+    rem(t, b.y, p); t *= q.x;
+    s -= t;
+    return divide(s,p);
+}
+
 void factor(Vec<Pair<GG, long> >& f, const GG& a)
 // f = factorization of a into gaussian primes
 // each element of f is a pair of prime and its exponent
@@ -43,8 +157,18 @@ void factor(Vec<Pair<GG, long> >& f, const GG& a)
     real(b) /= t;// primitive part
     imag(b) /= t;
     norm(s,b);
-    factor(g,s);
-    factor(h,t);// content
+    if(NumBits(s) > PAR_BITS && NumBits(t) > PAR_BITS) {
+        NTL_EXEC_RANGE(2, first, last)
+            for(long i=first; i<last; i++) {
+                if(i==0) factor(g,s);
+                else factor(h,t);// content
+            }
+        NTL_EXEC_RANGE_END
+    }
+    else {
+        factor(g,s);
+        factor(h,t);// content
+    }
     for(i=j=0; i<h.length(); i++) {
         if(trunc_long(h[i].a, 2) == 3) {
             f.SetLength(k+1);// real factor
@@ -65,17 +189,17 @@ void factor(Vec<Pair<GG, long> >& f, const GG& a)
     while(i<g.length() || j<h.length()) {// imaginary factor
         if(j==h.length() || i<g.length() && g[i].a < h[j].a) {
             f.SetLength(k+1);
-            FactorPrime(f[k].a, g[i].a);
-            if(!divide(b, f[k].a)) mirror(f[k].a, f[k].a);
+            SplitPrime(f[k].a, g[i].a);
+            if(!divisible(b, f[k].a, g[i].a)) mirror(f[k].a, f[k].a);
             f[k++].b = g[i++].b;
         }
         else {
             f.SetLength(k+2);
-            FactorPrime(f[k].a, h[j].a);
+            SplitPrime(f[k].a, h[j].a);
             mirror(f[k+1].a, f[k].a);
             f[k+1].b = f[k].b = h[j].b;
             if(i<g.length() && g[i].a == h[j].a) {
-                if(divide(b, f[k].a)) f[k].b += g[i++].b;
+                if(divisible(b, f[k].a, h[j].a)) f[k].b += g[i++].b;
                 else f[k+1].b += g[i++].b;
             }
             j++; k+=2;
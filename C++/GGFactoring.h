@@ -12,6 +12,14 @@ void factor(NTL::Vec<NTL::Pair<NTL::ZZ, long> >& f, const NTL::ZZ& n);
 //   vector of (prime, exponent) pair
 //   in increasing order of primes
 
+void factor(NTL::Vec<NTL::Vec<NTL::Pair<NTL::ZZ, long> > >& f, const NTL::Vec<NTL::ZZ>& n);
+// f[i] = prime factorization of |n[i]| as above
+//   small primes of all n[i] are found at once by SmoothPart
+
+void SmoothPart(NTL::Vec<NTL::ZZ>& s, const NTL::Vec<NTL::ZZ>& n);
+// s[i] = largest divisor of |n[i]| composed of primes up to 2^16
+//   (0 if n[i]==0) by batch smoothness detection
+
 void factor(NTL::Vec<NTL::Pair<GG, long> >& f, const GG& a);
 // f = factorization of a into gaussian primes
 // each element of f is a pair of prime and its exponent
@@ -0,0 +1,182 @@
+// uses NTL
+//   http://www.shoup.net/ntl
+
+#include<cstring>
+#include<algorithm>
+#include<NTL/BasicThreadPool.h>
+#include "GG.h"
+using namespace NTL;
+
+#define SIEVE_SEG (1L<<16) // bytes per segment (30 integers per byte)
+#define SIEVE_BLK 8L // consecutive segments per task
+#define SIEVE_MAX 62 // bits of largest norm
+#define SIEVE_LAT 46 // split primes from lattice points if norm < 2^SIEVE_LAT
+
+static const long W[8] = {1,7,11,13,17,19,23,29};// residues prime to 30
+static const long V[30] = {0,1,0,0,0,0,0,13,0,0,0,11,0,7,0,0,0,23,0,19,0,0,0,17,0,0,0,0,0,29};
+// V[r] = 1/r mod 30
+static const long U[30] = {-1,0,-1,-1,-1,-1,-1,1,-1,-1,-1,2,-1,3,-1,-1,-1,4,-1,5,-1,-1,-1,6,-1,-1,-1,-1,-1,7};
+// U[W[j]] = j, -1 if not prime to 30
+
+static void BasePrimes(Vec<long>& P, Vec<long>& Q, long n)
+// P = primes p such that 7 <= p <= n
+// Q = primes q such that q <= n and q==3 (mod 4)
+//   by sieve of eratosthenes on odd integers
+{
+    long i,j,p,m((n-1)/2);
+    Vec<char> s;
+    s.SetLength(m+1);
+    for(i=1; i<=m; i++) s[i] = 1;
+    for(i=1; (2*i+1)*(2*i+1) <= n; i++)
+        if(s[i]) for(j=2*i*(i+1); j<=m; j+=2*i+1) s[j] = 0;
+    P.SetLength(0);
+    Q.SetLength(0);
+    for(i=1; i<=m; i++) {
+        if(!s[i]) continue;
+        p = 2*i+1;
+        if(p>=7) P.append(p);
+        if((p&3)==3) Q.append(p);
+    }
+}
+
+static void push(Vec<long>& r, long x, long y)
+// append x,y to r
+{
+    r.append(x);
+    r.append(y);
+}
+
+static void split(Vec<long>& r, long p)
+// append primary x+iy and x-iy (y>0) where x^2 + y^2 = p
+{
+    long x,y;
+    FactorPrime(x,y,p);
+    if(y<0) y = -y;
+    push(r,x,y);
+    push(r,x,-y);
+}
+
+static void lattice(Vec<long>& z, const Vec<unsigned char>& s, long A, long B)
+// z[8*o+j] = x*2^32 + y if A + 30*o + W[j] = x^2 + y^2 is prime
+//   for x odd and y even in first quadrant and A <= x^2 + y^2 < B
+// primes are looked up in segment s of sieve starting at A
+// x,y run over annulus row by row with bounds of x updated incrementally
+{
+    long x,y,q,o,j,l(std::max(A,7L)),h(SqrRoot(B-1)+1),r(SqrRoot(l-1)+1);
+    for(y=2; y*y<B; y+=2) {
+        while(h>0 && (h-1)*(h-1) + y*y >= B) h--;// x^2 + y^2 < B iff x < h
+        while(r>0 && (r-1)*(r-1) + y*y >= l) r--;// x^2 + y^2 >= l iff x >= r
+        for(x = r|1; x<h; x+=2) {
+            q = x*x + y*y - A;
+            o = q/30;
+            j = U[q - 30*o];
+            if(j>=0 && (s[o]>>j&1)) z[8*o+j] = x<<32 | y;
+        }
+    }
+}
+
+static void sieve(Vec<GG>* r, long n, long L, long a, long b,
+                  const Vec<long>& P, const Vec<long>& Q)
+// r[k] = gaussian primes with norm in [a,b) and
+//   in [L + T*k, L + T*(k+1)) for k=0,...,n-1
+//   where T = 30*SIEVE_SEG and L==0 (mod 30)
+// byte o, bit j of segment k represents L + T*k + 30*o + W[j]
+//   and offsets of multiples of P[i] are carried over segments
+// split primes are decomposed by lattice() if b < 2^SIEVE_LAT
+//   else by cornacchia algorithm
+{
+    long i,j,k,o,p,q,m,l,x,y,A,B,np,e(L + 30*SIEVE_SEG*n);
+    Vec<long> u;// u[8*i+j] = next byte of multiple of P[i] at bit j
+    Vec<long> w;// real and imaginary parts of primes in segment
+    Vec<long> z;// decompositions of split primes from lattice()
+    Vec<unsigned char> s;
+    for(np=0; np<P.length() && P[np]*P[np] < e; np++);
+    u.SetLength(8*np);
+    s.SetLength(SIEVE_SEG);
+    if(NumBits(b) <= SIEVE_LAT) z.SetLength(8*SIEVE_SEG);
+    for(i=0; i<np; i++) {
+        p = P[i];
+        m = std::max(p, (L+p-1)/p);// least multiplier
+        for(j=0; j<8; j++) {
+            q = W[j]*V[p%30]%30;// p*q == W[j] (mod 30)
+            u[8*i+j] = (p*(m + (q - m%30 + 30)%30) - L)/30;
+        }
+    }
+    for(k=0; k<n; k++) {
+        Vec<GG>& g(r[k]);
+        A = L + 30*SIEVE_SEG*k;
+        B = std::min(A + 30*SIEVE_SEG, b);
+        l = (B-A+29)/30;
+        memset(s.elts(), 0xff, l);
+        for(i=0; i<np && P[i]*P[i] < B; i++) {
+            p = P[i];
+            for(j=0; j<8; j++) {
+                for(o = u[8*i+j]; o < SIEVE_SEG*k + l; o += p)
+                    s[o - SIEVE_SEG*k] &= ~(1<<j);
+                u[8*i+j] = o;
+            }
+        }
+        if(z.length()) lattice(z, s, A, B);
+        w.SetLength(0);
+        q = std::max(A,a);
+        if(q>0) q = SqrRoot(q-1) + 1;
+        i = std::lower_bound(Q.elts(), Q.elts() + Q.length(), q) - Q.elts();
+        if(A<=2 && a<=2 && 2<B) push(w,1,1);// 1+i
+        if(A<=5 && a<=5 && 5<B) split(w,5);
+        for(o=0; o<l; o++) {
+            for(m = s[o]; m; m &= m-1) {
+                j = __builtin_ctzl(m);
+                q = A + 30*o + W[j];
+                if(q<a || q<7 || q>=B || (q&3)!=1) continue;
+                for(; i<Q.length() && Q[i]*Q[i] < q; i++) push(w, -Q[i], 0);
+                if(!z.length()) { split(w,q); continue; }
+                x = z[8*o+j]>>32;
+                y = z[8*o+j]&0xffffffff;
+                if(((x+y)&3) != 1) x = -x;// primary
+                push(w,x,y);
+                push(w,x,-y);
+            }
+        }
+        for(; i<Q.length() && Q[i]*Q[i] < B; i++) push(w, -Q[i], 0);
+        g.SetLength(w.length()/2);
+        for(i=0; i<g.length(); i++) {
+            conv(g[i].x, w[2*i]);
+            conv(g[i].y, w[2*i+1]);
+        }
+    }
+}
+
+void GaussianPrimes(const ZZ& lo, const ZZ& hi,
+                    const std::function<void(const Vec<GG>&)>& f)
+// call f(p) for consecutive segments of [lo,hi)
+//   where p = gaussian primes with norm in the segment
+// each task sieves SIEVE_BLK segments of 30*SIEVE_SEG integers
+//   by wheel of 30 (one bit per integer prime to 30)
+// tasks are distributed over NTL's thread pool
+{
+    if(sign(lo)<0 || NumBits(hi) > SIEVE_MAX)
+        Error("GaussianPrimes: norm out of range");
+    if(lo>=hi) return;
+    long i,k,K,N,a(to_long(lo)),b(to_long(hi)),L(a - a%30);
+    Vec<long> P,Q;
+    Vec<Vec<GG> > r;
+    BasePrimes(P, Q, SqrRoot(b-1));
+    N = (b-L + 30*SIEVE_SEG-1)/(30*SIEVE_SEG);// number of segments
+    for(k=0; k<N; k+=K) {
+        K = std::min(N-k, AvailableThreads()*SIEVE_BLK);
+        r.SetLength(K);
+        NTL_EXEC_RANGE((K + SIEVE_BLK-1)/SIEVE_BLK, first, last)
+            for(long j=first; j<last; j++)
+                sieve(r.elts() + j*SIEVE_BLK, std::min(SIEVE_BLK, K - j*SIEVE_BLK),
+                      L + 30*SIEVE_SEG*(k + j*SIEVE_BLK), a, b, P, Q);
+        NTL_EXEC_RANGE_END
+        for(i=0; i<K; i++) f(r[i]);
+    }
+}
+
+void GaussianPrimes(Vec<GG>& p, const ZZ& lo, const ZZ& hi)
+// p = gaussian primes with norm in [lo,hi)
+{
+    p.SetLength(0);
+    GaussianPrimes(lo, hi, [&p](const Vec<GG>& r) { p.append(r); });
+}
@@ -0,0 +1,321 @@
+// uses NTL
+//   http://www.shoup.net/ntl
+
+#ifndef __GGT_h__
+#define __GGT_h__
+
+#include "GG.h"
+
+// Gaussian integer x+iy with fixed-width parts
+//   T = long, __int128 or NTL::ZZ
+// intermediate products must fit in T, so that
+//   GCD, XGCD, DivRem and ResSymb need |x|,|y| < 2^GGT_BITS(T)
+//   PowerMod needs |x|,|y| < 2^GGT_PMBITS(T) for modulus
+// GG calls these automatically when its operands are small enough,
+// and stays on the ZZ path otherwise
+
+#define GGT_LONG_BITS 30
+#define GGT_LONG_PMBITS 19
+#define GGT_INT128_BITS 62
+#define GGT_INT128_PMBITS 40
+
+template<class T> struct GGT {
+    T x,y;// real and imaginary part
+    GGT() : x(0),y(0) {;}
+    GGT(const T& a, const T& b) : x(a),y(b) {;}// a+bi
+    explicit GGT(long a) : x(a),y(0) {;}// a+0i
+};
+
+// scalar helpers for native and ZZ parts
+
+inline void FloorDiv(long& q, long a, long b) {// q = floor(a/b)
+    q = a/b;
+    if(a%b && (a<0) != (b<0)) q--;
+}
+
+inline void FloorDiv(__int128& q, __int128 a, __int128 b) {// q = floor(a/b)
+    __int128 r(a%b);
+    q = a/b;
+    if(r && (a<0) != (b<0)) q--;
+}
+
+inline void FloorDiv(NTL::ZZ& q, const NTL::ZZ& a, const NTL::ZZ& b)
+{ div(q,a,b); }
+
+inline long Mod16(long a) { return a&15; }// a mod 16 in [0,16)
+inline long Mod16(__int128 a) { return long(a&15); }
+inline long Mod16(const NTL::ZZ& a) { return rem(a,16); }
+
+inline void conv(__int128& a, const NTL::ZZ& b) {// a=b; assume |b| < 2^127
+    NTL::ZZ c;
+    unsigned long lo,hi;
+    abs(c,b);
+    lo = NTL::trunc_long(c,64);
+    c >>= 64;
+    hi = NTL::trunc_long(c,64);
+    a = (__int128)(((unsigned __int128)hi<<64) | lo);
+    if(sign(b) < 0) a = -a;
+}
+
+inline void conv(NTL::ZZ& a, __int128 b) {// a=b
+    unsigned __int128 c(b<0 ? -(unsigned __int128)b : b);
+    NTL::ZZ lo;
+    conv(a, (unsigned long)(c>>64));
+    conv(lo, (unsigned long)c);
+    a <<= 64;
+    a += lo;
+    if(b<0) negate(a,a);
+}
+
+template<class T> void conv(GGT<T>& b, const GG& a)// b=a
+{ conv(b.x, a.x); conv(b.y, a.y); }
+
+template<class T> void conv(GG& b, const GGT<T>& a)// b=a
+{ conv(b.x, a.x); conv(b.y, a.y); }
+
+template<class T> std::ostream& operator<<(std::ostream& s, const GGT<T>& a)
+{ GG b; conv(b,a); return s << b; }// print a as [a.x a.y]
+
+template<class T> inline long operator==(const GGT<T>& a, const GGT<T>& b)
+{ return a.x==b.x && a.y==b.y; }
+template<class T> inline long operator!=(const GGT<T>& a, const GGT<T>& b)
+{ return a.x!=b.x || a.y!=b.y; }
+template<class T> inline long IsZero(const GGT<T>& a)
+{ return a.x==0 && a.y==0; }
+template<class T> inline long IsOne(const GGT<T>& a)
+{ return a.x==1 && a.y==0; }
+template<class T> inline long IsUnit(const GGT<T>& a)// test if |a|==1
+{ return (a.y==0 && (a.x==1 || a.x==-1)) || (a.x==0 && (a.y==1 || a.y==-1)); }
+
+template<class T> void set(GGT<T>& a) { a.x=1; a.y=0; }// a=1
+template<class T> void clear(GGT<T>& a) { a.x=0; a.y=0; }// a=0
+
+template<class T> void swap(GGT<T>& a, GGT<T>& b)// exchange a and b
+{ using std::swap; swap(a.x, b.x); swap(a.y, b.y); }
+
+template<class T> void norm(T& n, const GGT<T>& a)// n = x**2 + y**2
+{ n = a.x*a.x + a.y*a.y; }
+
+template<class T> void conj(GGT<T>& b, const GGT<T>& a)// b = x-iy
+{ b.x = a.x; b.y = -a.y; }
+
+template<class T> void negate(GGT<T>& b, const GGT<T>& a)// b=-a
+{ b.x = -a.x; b.y = -a.y; }
+
+template<class T> void mul_i(GGT<T>& b, const GGT<T>& a)// b = i*a
+{ T t(a.x); b.x = -a.y; b.y = t; }
+
+template<class T> void div_i(GGT<T>& b, const GGT<T>& a)// b = a/i
+{ T t(a.x); b.x = a.y; b.y = -t; }
+
+template<class T> void mul_i(GGT<T>& b, const GGT<T>& a, long k)// b = a*i^k
+{
+    if((k&=3)==1) mul_i(b,a);
+    else if(k==2) negate(b,a);
+    else if(k==3) div_i(b,a);
+    else if(&b!=&a) b=a;
+}
+
+template<class T> long quadrant(const GGT<T>& a)
+// return -1 if a==0, else quadrant 0,1,2,3 as in quadrant(GG)
+{
+    if(a.x==0) {
+        if(a.y==0) return -1;
+        else if(a.y > 0) return 1;
+        else return 3;
+    }
+    else if(a.x > 0) {
+        if(a.y < 0) return 3;
+        else return 0;
+    }
+    else if(a.y > 0) return 1;
+    else return 2;
+}
+
+template<class T> long FirstQuad(GGT<T>& b, const GGT<T>& a)
+// b = a * i^k (k=0,1,2,3) such that Re(b)>0 and Im(b)>=0
+// return k; k==0 if a==0
+{
+    long k(quadrant(a));
+    if(k>0) k=4-k; else k=0;
+    mul_i(b,a,k);
+    return k;
+}
+
+template<class T> void add(GGT<T>& c, const GGT<T>& a, const GGT<T>& b)
+{ c.x = a.x + b.x; c.y = a.y + b.y; }// c=a+b
+
+template<class T> void sub(GGT<T>& c, const GGT<T>& a, const GGT<T>& b)
+{ c.x = a.x - b.x; c.y = a.y - b.y; }// c=a-b
+
+template<class T> void mul(GGT<T>& c, const GGT<T>& a, const GGT<T>& b)
+{// c=a*b
+    T s(a.x*b.x), t(a.y*b.y), u((a.y - a.x)*(b.x - b.y));
+    c.x = s - t;
+    c.y = u + s + t;
+}
+
+template<class T> void sqr(GGT<T>& b, const GGT<T>& a)
+{// b=a*a
+    T s((a.x + a.y)*(a.x - a.y));
+    b.y = 2*(a.x*a.y);
+    b.x = s;
+}
+
+template<class T> void div(GGT<T>& q, const GGT<T>& a, const GGT<T>& b)
+// q = quotient of a/b such that
+//   a = bq + r and |r/b|^2 <= 1/2
+{
+    T n;
+    GGT<T> c;
+    if(b.y==0) {
+        n = b.x;
+        c = a;
+    }
+    else if(b.x==0) {
+        n = b.y;
+        div_i(c,a);
+    }
+    else {
+        norm(n,b);
+        conj(c,b);
+        mul(c,c,a);
+    }
+    c.x = 2*c.x + n;
+    c.y = 2*c.y + n;
+    n = 2*n;
+    FloorDiv(q.x, c.x, n);
+    FloorDiv(q.y, c.y, n);
+}
+
+template<class T> void DivRem(GGT<T>& q, GGT<T>& r, const GGT<T>& a, const GGT<T>& b)
+// q,r = quotient and remainder of a/b such that
+//   a = bq + r and |r/b|^2 <= 1/2
+{
+    GGT<T> c(a), d(b);
+    div(q,c,d);
+    mul(r,d,q);
+    sub(r,c,r);
+}
+
+template<class T> void rem(GGT<T>& r, const GGT<T>& a, const GGT<T>& b)
+{ GGT<T> q; DivRem(q,r,a,b); }// r = a mod b
+
+template<class T> long divide2(GGT<T>& q, const GGT<T>& a)
+// if a is divisible by 1+i, set q=a/(1+i) and return 1
+// else return 0 and q is unchanged
+{
+    if((Mod16(a.x) ^ Mod16(a.y)) & 1) return 0;
+    T x(a.x);
+    q.x = (x + a.y)/2;
+    q.y = (a.y - x)/2;
+    return 1;
+}
+
+template<class T> void GCD(GGT<T>& d, const GGT<T>& a, const GGT<T>& b)
+// d = greatest common divisor of a and b
+//   in first quadrant Re(d)>0 and Im(d)>=0
+{
+    GGT<T> x(a),y(b),r;
+    while(!IsZero(y)) {
+        rem(r,x,y);
+        x=y;
+        y=r;
+    }
+    FirstQuad(d,x);
+}
+
+template<class T>
+void XGCD(GGT<T>& d, GGT<T>& s, GGT<T>& t, const GGT<T>& a, const GGT<T>& b)
+// d = greatest common divisor of a and b
+//   in first quadrant Re(d)>0 and Im(d)>=0
+//   and compute s,t such that d = s*a + t*b
+{
+    long c;
+    GGT<T> x(a),y(b),u,v(1),q,r;
+    set(s);
+    clear(t);
+    while(!IsZero(y)) {
+        DivRem(q,r,x,y);
+        mul(x,q,u);
+        sub(x,s,x);
+        s=u;
+        u=x;
+        mul(x,q,v);
+        sub(x,t,x);
+        t=v;
+        v=x;
+        x=y;
+        y=r;
+    }
+    c = FirstQuad(d,x);
+    mul_i(s,s,c);
+    mul_i(t,t,c);
+}
+
+template<class T, class E>
+void PowerMod(GGT<T>& b, const GGT<T>& a, const E& n, const GGT<T>& m)
+// b = a^n mod m; assume n>=0 and |a| < |m|
+// E = long or NTL::ZZ
+{
+    if(n==0 || IsOne(a)) { set(b); return; }
+    GGT<T> c(a);
+    b=c;
+    for(long k=NTL::NumBits(n)-2; k>=0; k--) {
+        sqr(b,b); rem(b,b,m);
+        if(NTL::bit(n,k)) { mul(b,b,c); rem(b,b,m); }
+    }
+}
+
+template<class T> long primary(GGT<T>& b, const GGT<T>& a)
+// b = unit * a = x+iy such that
+//   x==1 and y==0 or x==3 and y==2 (mod 4)
+// return k such that a = i^k * b (k=0,1,2,3)
+// Assume |a|^2 is odd
+{
+    long x(Mod16(a.x)&3), y(Mod16(a.y)&3);
+    if(y&1) {
+        div_i(b,a);
+        if(x+y != 3) return 1;
+        negate(b,b);
+        return 3;
+    }
+    if(x+y == 3) {
+        negate(b,a);
+        return 2;
+    }
+    if(&b!=&a) b=a;
+    return 0;
+}
+
+template<class T> void ResSymb(GGT<T>& s, const GGT<T>& a, const GGT<T>& b)
+// s = biquadratic residue symbol (a/b)_4 = 0,1,i,-1,-i
+// Assume |a| < |b| and |b|^2 is odd
+// Assume b is primary, but may not be prime
+{
+    long j(0),k,m,n;
+    GGT<T> u(a),v(b),w;
+    while(!IsZero(u)) {
+        m = Mod16(v.x);// m odd
+        n = Mod16(v.y);// n even
+        k = (m-n)>>2;
+        if(n &= 2) k--;
+        m >>= 1; m &= 3; k &= 3;
+
+        while(divide2(u,u)) j += k;// supplementary law for 1+i
+        if(k = primary(u,u)) j -= k*m;// supplementary law for units
+        if(n && (Mod16(u.y)&2)) j += 2;// reciprocity
+        j &= 3;
+
+        rem(w,v,u);
+        v = u;
+        u = w;
+    }
+    if(!IsUnit(v)) clear(s);
+    else if(j==0) set(s);
+    else if(j==1) { s.x=0; s.y=1; }
+    else if(j==2) { s.x=-1; s.y=0; }
+    else { s.x=0; s.y=-1; }
+}
+
+#endif // __GGT_h__
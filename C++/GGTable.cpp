@@ -0,0 +1,142 @@
+// uses NTL
+//   http://www.shoup.net/ntl
+
+#include<cstdio>
+#include<cstring>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<NTL/BasicThreadPool.h>
+#include "GG.h"
+#include "GGTable.h"
+using namespace NTL;
+
+static const char *MAGIC = "GGPRIME";
+
+static const GGTableHeader *T;// opened table
+static const uint32_t *S;// start of buckets
+static const GGTableEntry *E;// entries
+static size_t Z;// size of mapping
+
+static long buckets(uint64_t bound, long shift)
+// number of elements of start array
+{
+    return bound ? ((bound-1)>>shift) + 2 : 1;
+}
+
+void WriteGGTable(const char *file, long bound)
+// write table of primes p < bound into file
+// assume bound <= 2^32
+// primes are enumerated by GaussianPrimes
+//   and decomposed by FactorPrime over NTL's thread pool
+{
+    if(bound<0 || bound > (1L<<32)) Error("WriteGGTable: bound out of range");
+    long i,n(buckets(bound, GGTABLE_SHIFT));
+    GGTableHeader h;
+    Vec<uint32_t> s;
+    FILE *fp(fopen(file, "wb"));
+    if(!fp) Error("WriteGGTable: cannot open file");
+    memset(&h, 0, sizeof(h));
+    strcpy(h.magic, MAGIC);
+    h.version = GGTABLE_VERSION;
+    h.shift = GGTABLE_SHIFT;
+    h.bound = bound;
+    s.SetLength(n);
+    for(i=0; i<n; i++) s[i] = 0;
+    fwrite(&h, sizeof(h), 1, fp);// reserve header and buckets
+    fwrite(s.elts(), sizeof(uint32_t), n, fp);
+    GaussianPrimes(ZZ(0), ZZ(bound), [&](const Vec<GG>& r) {
+        long k;
+        Vec<long> p;
+        Vec<GGTableEntry> e;
+        for(k=0; k<r.length(); k++)// one of conjugates of split primes
+            if(sign(r[k].y) > 0 && !IsOdd(r[k].y)) {
+                long x(to_long(r[k].x)), y(to_long(r[k].y));
+                p.append(x*x + y*y);
+            }
+        e.SetLength(p.length());
+        NTL_EXEC_RANGE(p.length(), first, last)
+            for(long j=first; j<last; j++) {
+                long x,y;
+                FactorPrime(x, y, p[j]);
+                e[j].p = p[j];
+                e[j].x = labs(x);
+                e[j].y = labs(y) + (y<0);
+            }
+        NTL_EXEC_RANGE_END
+        for(k=0; k<p.length(); k++) s[(p[k]>>GGTABLE_SHIFT) + 1]++;
+        fwrite(e.elts(), sizeof(GGTableEntry), e.length(), fp);
+        h.count += e.length();
+    });
+    for(i=1; i<n; i++) s[i] += s[i-1];
+    rewind(fp);
+    fwrite(&h, sizeof(h), 1, fp);
+    fwrite(s.elts(), sizeof(uint32_t), n, fp);
+    if(ferror(fp) | fclose(fp)) Error("WriteGGTable: cannot write file");
+}
+
+long OpenGGTable(const char *file)
+// map table in file read-only and shared with other processes
+// return 1 if success, 0 if file is not a table of this version
+// header and size of file are checked but entries are not read
+{
+    int fd;
+    long n;
+    struct stat st;
+    void *m;
+    const GGTableHeader *h;
+    CloseGGTable();
+    if((fd = open(file, O_RDONLY)) < 0) return 0;
+    if(fstat(fd, &st) || st.st_size < long(sizeof(GGTableHeader))) {
+        close(fd);
+        return 0;
+    }
+    m = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(m == MAP_FAILED) return 0;
+    h = (const GGTableHeader *)m;
+    if(memcmp(h->magic, MAGIC, sizeof(h->magic)) ||
+       h->version != GGTABLE_VERSION ||
+       h->shift > 16 || h->bound > (1UL<<32) ||
+       st.st_size != long(sizeof(*h) + (n = buckets(h->bound, h->shift))*sizeof(uint32_t)
+                          + h->count*sizeof(GGTableEntry))) {
+        munmap(m, st.st_size);
+        return 0;
+    }
+    T = h;
+    S = (const uint32_t *)(h+1);
+    E = (const GGTableEntry *)(S+n);
+    Z = st.st_size;
+    return 1;
+}
+
+void CloseGGTable()
+// unmap table opened by OpenGGTable
+{
+    if(!T) return;
+    munmap((void *)T, Z);
+    T = 0;
+}
+
+long LookupPrime(long& x, long& y, long p)
+// if p is in opened table, set x+iy = FactorPrime(p) and return 1
+// else return 0
+{
+    long i,j,k;
+    uint16_t q(p);
+    if(!T || p<0 || uint64_t(p) >= T->bound) return 0;
+    i = S[p >> T->shift];
+    j = S[(p >> T->shift) + 1];
+    while(i<j) {// binary search for p mod 2^16 in bucket
+        k = (i+j)>>1;
+        if(E[k].p < q) i = k+1;
+        else j = k;
+    }
+    if(i == S[(p >> T->shift) + 1] || E[i].p != q) return 0;
+    x = E[i].x;
+    y = E[i].y & ~1;
+    if(E[i].y & 1) y = -y;
+    if(((x+y)&3) != 1) x = -x;// primary
+    return 1;
+}
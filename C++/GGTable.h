@@ -0,0 +1,52 @@
+// uses NTL
+//   http://www.shoup.net/ntl
+
+#ifndef __GGTable_h__
+#define __GGTable_h__
+
+#include<cstdint>
+
+#define GGTABLE_VERSION 1
+#define GGTABLE_SHIFT 12 // primes p are in bucket p>>GGTABLE_SHIFT
+
+// binary table of FactorPrime(p) for primes p==1 (mod 4), p < bound
+// in native byte order (version does not match otherwise)
+//   GGTableHeader
+//   uint32_t start[(bound-1 >> shift) + 2];// first entry of bucket
+//   GGTableEntry e[count];// in increasing order of p
+
+struct GGTableHeader {
+    char magic[8];// "GGPRIME"
+    uint32_t version;// GGTABLE_VERSION
+    uint32_t shift;// GGTABLE_SHIFT
+    uint64_t bound;// <= 2^32
+    uint64_t count;// number of primes
+};
+
+struct GGTableEntry {// x+iy = FactorPrime(p)
+    uint16_t p;// p mod 2^16
+    uint16_t x;// |x|, sign of x is such that x+y==1 (mod 4)
+    uint16_t y;// |y| + (y<0)
+};
+
+void WriteGGTable(const char *file, long bound);
+// write table of primes p < bound into file
+// assume bound <= 2^32
+// primes are enumerated by GaussianPrimes
+
+long OpenGGTable(const char *file);
+// map table in file read-only and shared with other processes
+//   and use it in FactorPrime for primes less than its bound
+// return 1 if success, 0 if file is not a table of this version
+// previously opened table is closed
+// call before other threads use FactorPrime
+
+void CloseGGTable();
+// unmap table opened by OpenGGTable
+
+long LookupPrime(long& x, long& y, long p);
+// if p is in opened table, set x+iy = FactorPrime(p) and return 1
+// else return 0
+// by binary search in bucket of p
+
+#endif // __GGTable_h__
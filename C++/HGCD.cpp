@@ -0,0 +1,186 @@
+// uses NTL
+//   http://www.shoup.net/ntl
+
+#include "GGT.h"
+using namespace NTL;
+
+#define HGCD_WORD  61 // bits of leading parts for native steps
+#define HGCD_GUARD 4  // guard bits for native steps
+#define HGCD_BITS  8000 // use recursion if operands are longer
+#define HGCD_RGUARD 32 // guard bits for recursive steps
+
+struct GGMat {// 2x2 matrix [[a b] [c d]] of gaussian integers
+    GG a,b,c,d;
+};
+
+static void set(GGMat& M) { set(M.a); clear(M.b); clear(M.c); set(M.d); }// M=1
+
+static void swap(GGMat& M) {// exchange rows of M
+    swap(M.a.x, M.c.x); swap(M.a.y, M.c.y);
+    swap(M.b.x, M.d.x); swap(M.b.y, M.d.y);
+}
+
+static void mul(GGMat& M, const GGMat& N)
+{// M = N*M
+    GG s,t,u,v,w;
+    mul(s, N.a, M.a); mul(w, N.b, M.c); s += w;
+    mul(t, N.a, M.b); mul(w, N.b, M.d); t += w;
+    mul(u, N.c, M.a); mul(w, N.d, M.c); u += w;
+    mul(v, N.c, M.b); mul(w, N.d, M.d); v += w;
+    M.a = s; M.b = t; M.c = u; M.d = v;
+}
+
+static void apply(GG& x, GG& y, const GGMat& M)
+{// (x,y) = M*(x,y)
+    GG s,t,w;
+    mul(s, M.a, x); mul(w, M.b, y); s += w;
+    mul(t, M.c, x); mul(w, M.d, y); t += w;
+    x = s; y = t;
+}
+
+static long Bits(const GG& a)
+{// number of bits of max(|x|,|y|)
+    long k(NumBits(a.x)), l(NumBits(a.y));
+    return k>l ? k:l;
+}
+
+static long Bits(__int128 a)
+{// number of bits of |a|
+    unsigned __int128 b(a<0 ? -(unsigned __int128)a : a);
+    unsigned long h(b>>64);
+    if(h) return 128 - __builtin_clzl(h);
+    if(unsigned long l = b) return 64 - __builtin_clzl(l);
+    return 0;
+}
+
+static long Bits(const GGT<__int128>& a)
+{// number of bits of max(|x|,|y|)
+    long k(Bits(a.x)), l(Bits(a.y));
+    return k>l ? k:l;
+}
+
+static double LogNorm(const GG& a)
+{// approximation of log|a|^2; -1 if a==0
+    long k(Bits(a) - 60);
+    double x,y;
+    if(k<0) k=0;
+    x = to_double(RightShift(a.x, k));
+    y = to_double(RightShift(a.y, k));
+    if(x==0 && y==0) return -1;
+    return log(x*x + y*y) + 2*k*log(2.);
+}
+
+static void Step(GG& x, GG& y, GGMat* M)
+// (x,y) = (y, x mod y) by one euclidean step
+// and M = [[0 1] [1 -q]] * M where q = x/y
+{
+    GG q,r;
+    DivRem(q,r,x,y);
+    x = y;
+    y = r;
+    if(M==0) return;
+    mul(r, q, M->c); sub(r, M->a, r);
+    M->a = M->c; M->c = r;
+    mul(r, q, M->d); sub(r, M->b, r);
+    M->b = M->d; M->d = r;
+}
+
+static long Lehmer(GGMat& N, const GG& x, const GG& y, long t)
+// N = product of euclidean steps on leading HGCD_WORD bits of x,y
+//   stop before |y| gets shorter than t bits
+//   or before quotients may become wrong
+// return number of steps
+// Assume |x| >= |y|
+{
+    long i,k(Bits(x) - HGCD_WORD),l;
+    GGT<__int128> u,v,q,r,a(1),b,c,d(1),e,f,g;
+    GG w;
+    if(k<0) k=0;
+    RightShift(w.x, x.x, k); RightShift(w.y, x.y, k); conv(u,w);
+    RightShift(w.x, y.x, k); RightShift(w.y, y.y, k); conv(v,w);
+    for(i=0; !IsZero(v) && Bits(v)+k > t; i++) {
+        DivRem(q,r,u,v);
+        l = Bits(c); if(Bits(d) > l) l = Bits(d);
+        if(Bits(q) + l >= HGCD_WORD) break;
+        mul(g,q,c); sub(e,a,g);
+        mul(g,q,d); sub(f,b,g);
+        l = Bits(e); if(Bits(f) > l) l = Bits(f);
+        if(Bits(r) <= l + HGCD_GUARD) break;
+        a=c; b=d; c=e; d=f;
+        u=v; v=r;
+    }
+    conv(N.a,a); conv(N.b,b); conv(N.c,c); conv(N.d,d);
+    return i;
+}
+
+static void Reduce(GG& x, GG& y, GGMat* M, long t)
+// reduce (x,y) by euclidean steps until |y| < 2^t
+//   with |x| >= |y| on exit
+// if M!=0, set M such that (x,y) = M * (input x,y)
+{
+    long n,h,k;
+    double p;
+    GG u,v;
+    GGMat N;
+    if(M) set(*M);
+    if(LogNorm(x) < LogNorm(y)) {
+        swap(x,y);
+        if(M) swap(*M);
+    }
+    while(!IsZero(y) && Bits(y) > t) {
+        n = Bits(x);
+        h = n - t;
+        if(n < HGCD_BITS || h < 4*HGCD_RGUARD) {
+            if(Lehmer(N,x,y,t) == 0) { Step(x,y,M); continue; }
+        }
+        else {// recursion on leading 2h bits
+            if(3*h > n) h = n/3;
+            k = n - 2*h;
+            RightShift(u.x, x.x, k); RightShift(u.y, x.y, k);
+            RightShift(v.x, y.x, k); RightShift(v.y, y.y, k);
+            Reduce(u,v,&N,h+HGCD_RGUARD);
+        }
+        p = LogNorm(x) + LogNorm(y);
+        u = x; v = y;
+        apply(u,v,N);
+        if(LogNorm(u) < LogNorm(v)) { swap(u,v); swap(N); }
+        if(IsZero(v) || LogNorm(u) + LogNorm(v) < p - 0.5) {
+            x = u; y = v;
+            if(M) mul(*M,N);
+        }
+        else Step(x,y,M);// no progress
+    }
+}
+
+void LehmerGCD(GG& d, const GG& a, const GG& b)
+// d = greatest common divisor of a and b
+//   in first quadrant Re(d)>0 and Im(d)>=0
+// by Lehmer's algorithm and recursive half-gcd
+{
+    GG x(a),y(b);
+    Reduce(x,y,0,GGT_INT128_BITS);
+    if(IsZero(y)) { FirstQuad(d,x); return; }
+    Step(x,y,0);
+    GCD(d,x,y);
+}
+
+void LehmerXGCD(GG& d, GG& s, GG& t, const GG& a, const GG& b)
+// d = greatest common divisor of a and b
+//   in first quadrant Re(d)>0 and Im(d)>=0
+//   and compute s,t such that d = s*a + t*b
+// by Lehmer's algorithm and recursive half-gcd
+{
+    GG x(a),y(b),u,v;
+    GGMat M;
+    Reduce(x,y,&M,GGT_INT128_BITS);
+    if(IsZero(y)) {
+        long k(FirstQuad(d,x));
+        mul_i(s, M.a, k);
+        mul_i(t, M.b, k);
+        return;
+    }
+    Step(x,y,&M);
+    XGCD(d,u,v,x,y);
+    mul(s, u, M.a); mul(x, v, M.c); s += x;
+    mul(t, u, M.b); mul(y, v, M.d); t += y;
+}
\ No newline at end of file
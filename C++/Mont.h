@@ -0,0 +1,95 @@
+// uses NTL
+//   http://www.shoup.net/ntl
+
+#ifndef __Mont_h__
+#define __Mont_h__
+
+#include<NTL/ZZ.h>
+
+typedef unsigned __int128 u128;
+
+// montgomery arithmetic mod odd n in single or double words
+//   mul(a,b) = a*b/R mod n where R = 2^64 or 2^128
+//   to(a) = a*R mod n, from(a) = a/R mod n
+// values are in [0,n)
+
+struct Mont64 {// n < 2^63
+    typedef unsigned long T;
+    T n,m;// m = -1/n mod 2^64
+    T one,r2;// R and R^2 mod n
+    Mont64(T a) : n(a) {
+        m = n;// 1/n mod 8
+        for(int i=0; i<5; i++) m *= 2 - n*m;
+        m = -m;
+        one = (T(0) - n)%n;
+        r2 = one;
+        for(int i=0; i<64; i++) r2 = add(r2,r2);
+    }
+    T mul(T a, T b) const {
+        u128 t(u128(a)*b);
+        T u(T(t)*m);
+        T s((t + u128(u)*n)>>64);
+        return (s>=n ? s-n : s);
+    }
+    T add(T a, T b) const { a += b; return (a>=n ? a-n : a); }
+    T sub(T a, T b) const { return (a>=b ? a-b : b-a); }// |a-b|
+    T to(T a) const { return mul(a,r2); }
+    T from(T a) const { return mul(a,1); }
+    T power(T a, T e) const {// a^e in montgomery form
+        T b(one);
+        for(; e; e>>=1, a=mul(a,a)) if(e&1) b = mul(b,a);
+        return b;
+    }
+};
+
+struct Mont128 {// n < 2^127
+    typedef u128 T;
+    T n,m;// m = -1/n mod 2^128
+    T one,r2;// R and R^2 mod n
+    Mont128(T a) : n(a) {
+        m = n;
+        for(int i=0; i<6; i++) m *= 2 - n*m;
+        m = -m;
+        one = (T(0) - n)%n;
+        r2 = one;
+        for(int i=0; i<128; i++) r2 = add(r2,r2);
+    }
+    static void mul(T& h, T& l, T a, T b) {// (h,l) = a*b
+        unsigned long a0(a), a1(a>>64), b0(b), b1(b>>64);
+        T p00(u128(a0)*b0), p01(u128(a0)*b1), p10(u128(a1)*b0), p11(u128(a1)*b1);
+        T c((p00>>64) + (unsigned long)p01 + (unsigned long)p10);
+        l = (c<<64) | (unsigned long)p00;
+        h = p11 + (p01>>64) + (p10>>64) + (c>>64);
+    }
+    T mul(T a, T b) const {
+        T h,l,u,v,w;
+        mul(h,l,a,b);
+        mul(v,w,l*m,n);// l+w == 0 mod R
+        u = h + v + (l!=0);
+        return (u>=n ? u-n : u);
+    }
+    T add(T a, T b) const { a += b; return (a>=n ? a-n : a); }
+    T sub(T a, T b) const { return (a>=b ? a-b : b-a); }// |a-b|
+    T to(T a) const { return mul(a,r2); }
+    T from(T a) const { return mul(a,1); }
+    T power(T a, T e) const {// a^e in montgomery form
+        T b(one);
+        for(; e; e>>=1, a=mul(a,a)) if(e&1) b = mul(b,a);
+        return b;
+    }
+};
+
+inline void conv(u128& a, const NTL::ZZ& b) {// a=b; assume 0 <= b < 2^128
+    a = (unsigned long)NTL::trunc_long(b>>64, 64);
+    a = (a<<64) | (unsigned long)NTL::trunc_long(b,64);
+}
+
+inline void conv(NTL::ZZ& a, u128 b) {// a=b
+    NTL::ZZ c;
+    conv(a, (unsigned long)(b>>64));
+    conv(c, (unsigned long)b);
+    a <<= 64;
+    a += c;
+}
+
+#endif // __Mont_h__
@@ -15,6 +15,41 @@ void mod(ZZ_p& b, const GG& a, const GG& p)
     conv(x, a.x); sub(b, x, y);
 }
 
+void PowerModPrime(GG& b, const GG& a, const ZZ& n, const GGModulus& M)
+// b = a^n mod p; assume n>=0 and p is gaussian prime
+// by isomorphism Z[i]/(p) == ZZ_p or ZZ_p[i]/(i^2+1)
+{
+    const GG& p(M.m);
+    ZZ_p c;
+
+    if(IsZero(n)) { set(b); return; }
+    if(!IsZero(p.x) && !IsZero(p.y)) {
+        ZZ_pPush _p(M.n);
+        mod(c,a,p);
+        power(c,c,n);
+        conv(b, rep(c));
+    }
+    else {// F_{q^2} = ZZ_p[i]/(i^2+1)
+        ZZ_p x,y,u,v,s,t;
+        ZZ_pPush _p(abs(IsZero(p.y) ? p.x : p.y));
+        conv(u, a.x);
+        conv(v, a.y);
+        x=u; y=v;
+        for(long k=NumBits(n)-2; k>=0; k--) {
+            add(s,x,y); sub(t,x,y); mul(y,x,y); add(y,y,y);
+            mul(x,s,t);// (x+iy)^2
+            if(bit(n,k)) {
+                mul(s,x,u); mul(t,y,v); sub(s,s,t);
+                mul(t,x,v); mul(y,y,u); add(y,y,t);
+                x=s;// (x+iy)(u+iv)
+            }
+        }
+        conv(b.x, rep(x));
+        conv(b.y, rep(y));
+    }
+    rem(b,b,M);
+}
+
 void QrtRootMod(GG& x, const GG& a, const GG& p)
 // solve x^4 == a (mod p)
 // Assume p is primary prime and (a/p)_4 == 1
@@ -22,13 +57,19 @@ void QrtRootMod(GG& x, const GG& a, const GG& p)
 //   norm(p) is prime and norm(p)==1 (mod 4)
 //   or norm(p) is prime^2 and p==3 (mod 4)
 {
+    QrtRootMod(x, a, GGModulus(p));
+}
+
+void QrtRootMod(GG& x, const GG& a, const GGModulus& M)
+// same as QrtRootMod(x,a,M.m)
+{
+    const GG& p(M.m);
     ZZ_p c;
     ZZ_pX f;
 
     if(!IsZero(p.y)) {
         ZZ n;
-        norm(n,p);
-        ZZ_pPush _p(n);
+        ZZ_pPush _p(M.n);
         mod(c,a,p);
         negate(c,c);
         SetCoeff(f,4);
@@ -36,7 +77,7 @@ void QrtRootMod(GG& x, const GG& a, const GG& p)
         FindRoot(c,f);
         conv(n,c);
         conv(x,n);
-        x %= p;
+        rem(x,x,M);
     }
     else {
         ZZ_pE b;
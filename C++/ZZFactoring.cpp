@@ -8,6 +8,7 @@ using namespace NTL;
 #define TRYDIV_BOUND (1<<16)
 #define MR_NUM_TRIAL 20
 #define RHO_TIME_OUT 5
+#define ECM_DIGITS 50 // digits of factors for ecm if mpqs fails
 
 long IsPrimePower(ZZ& p, const ZZ& n, long N)
 // input:
@@ -39,7 +40,27 @@ long IsPrimePower(ZZ& p, const ZZ& n, long N)
 }
 
 long brent_rho(ZZ&, const ZZ&, double);
-long mpqs(ZZ&, const ZZ&);
+long ecm(ZZ&, const ZZ&, long, long&);
+long mpqs(Vec<ZZ>&, const ZZ&);
+
+static void merge(Vec<Pair<ZZ, long> >& f, const Vec<Pair<ZZ, long> >& g)
+// f = f*g where f,g are factorizations in increasing order of primes
+{
+    long i,j,k;
+    Vec<Pair<ZZ, long> > h;
+    for(i=j=k=0; i<f.length() || j<g.length(); k++) {
+        h.SetLength(k+1);
+        if(j==g.length() || i<f.length() && f[i].a < g[j].a)
+            h[k] = f[i++];
+        else if(i==f.length() || f[i].a > g[j].a)
+            h[k] = g[j++];
+        else {
+            h[k] = f[i++];
+            h[k].b += g[j++].b;
+        }
+    }
+    swap(f,h);
+}
 
 void factor_(Vec<Pair<ZZ, long> >& f, const ZZ& n)
 // input:
@@ -47,8 +68,8 @@ void factor_(Vec<Pair<ZZ, long> >& f, const ZZ& n)
 // output:
 //   f = prime factorization of n (appended to f)
 {
-    long i,j,k(f.length());
-    ZZ p,q;
+    long i,j,k(f.length()),L(0);// L = next level of ecm
+    ZZ p;
     if(j = IsPrimePower(p, n, MR_NUM_TRIAL)) {
         f.SetLength(k+1);
         f[k].a = p;
@@ -56,22 +77,124 @@ void factor_(Vec<Pair<ZZ, long> >& f, const ZZ& n)
         return;
     }
     Vec<Pair<ZZ, long> > g,h;
+    Vec<ZZ> s;// n = product of s
     if(brent_rho(p, n, RHO_TIME_OUT) == 0);
-    else if(mpqs(p,n) == 0);
+    else if(ecm(p, n, 0, L) == 0);
+    else if(mpqs(s,n) == 0);// mostly primes already
+    else if(ecm(p, n, ECM_DIGITS, L) == 0) s.SetLength(0);// continue from level L
     else Error("factor not found");
-    div(q,n,p);
-    factor_(g,p);
-    factor_(h,q);
-    for(i=j=0; i<g.length() || j<h.length(); k++) {
-        f.SetLength(k+1);
-        if(j==h.length() || i<g.length() && g[i].a < h[j].a)
-            f[k] = g[i++];
-        else if(i==g.length() || g[i].a > h[j].a)
-            f[k] = h[j++];
-        else {
-            f[k] = g[i++];
-            f[k].b += h[j++].b;
+    if(s.length() == 0) {
+        s.SetLength(2);
+        s[0] = p;
+        div(s[1],n,p);
+    }
+    for(i=0; i<s.length(); i++) {
+        g.SetLength(0);
+        factor_(g,s[i]);
+        merge(h,g);
+    }
+    f.SetLength(k + h.length());
+    for(i=0; i<h.length(); i++) f[k+i] = h[i];
+}
+
+static void ProductTree(Vec<Vec<ZZ> >& T, const Vec<ZZ>& x)
+// T[0] = x, T[l][i] = T[l-1][2i] * T[l-1][2i+1]
+//   until T[l] has one element (T[l][i] = T[l-1][2i] if 2i+1 is out)
+{
+    long i,l;
+    T.SetLength(1);
+    T[0] = x;
+    for(l=1; T[l-1].length() > 1; l++) {
+        T.SetLength(l+1);
+        T[l].SetLength((T[l-1].length() + 1)/2);
+        for(i=0; i<T[l].length(); i++) {
+            if(2*i+1 < T[l-1].length()) mul(T[l][i], T[l-1][2*i], T[l-1][2*i+1]);
+            else T[l][i] = T[l-1][2*i];
+        }
+    }
+}
+
+struct ZZPrimeTree {// product tree of primes up to TRYDIV_BOUND
+    Vec<Vec<ZZ> > T;
+    ZZPrimeTree() {
+        long p;
+        Vec<ZZ> x;
+        PrimeSeq ps;
+        while((p = ps.next()) <= TRYDIV_BOUND) {
+            x.SetLength(x.length()+1);
+            conv(x[x.length()-1], p);
         }
+        ProductTree(T,x);
+    }
+};
+
+static const Vec<Vec<ZZ> >& PrimeTree()
+{// built once on first call
+    static ZZPrimeTree P;
+    return P.T;
+}
+
+static void divisors(Vec<long>& p, const ZZ& g, const Vec<Vec<ZZ> >& T, long l, long i)
+// append primes in subtree T[l][i] of PrimeTree that divide g
+//   in increasing order
+{
+    long j;
+    ZZ h;
+    if(l==0) { p.append(to_long(T[0][i])); return; }
+    for(j=2*i; j<=2*i+1 && j<T[l-1].length(); j++) {
+        GCD(h, g, T[l-1][j]);
+        if(!IsOne(h)) divisors(p,h,T,l-1,j);
+    }
+}
+
+static void trial(Vec<Pair<ZZ, long> >& f, ZZ& m, const ZZ& g)
+// remove primes dividing g from m and append them to f
+//   with their exponents in m
+// assume g divides a power of product of primes in PrimeTree
+{
+    const Vec<Vec<ZZ> >& T(PrimeTree());
+    long i,j,k(f.length());
+    Vec<long> p;
+    if(IsOne(g)) return;
+    divisors(p, g, T, T.length()-1, 0);
+    f.SetLength(k + p.length());
+    for(i=0; i<p.length(); i++, k++) {
+        for(j=0; divide(m,m,p[i]); j++);
+        f[k].a = p[i];
+        f[k].b = j;
+    }
+}
+
+void SmoothPart(Vec<ZZ>& s, const Vec<ZZ>& n)
+// input:
+//   n = vector of integers
+// output:
+//   s[i] = largest divisor of |n[i]| composed of primes up to TRYDIV_BOUND
+//          (0 if n[i]==0)
+//       by remainder tree of product of primes
+// reference:
+//   D. J. Bernstein "How to Find Smooth Parts of Integers" (2004)
+{
+    const Vec<Vec<ZZ> >& P(PrimeTree());
+    long i,j,l;
+    Vec<Vec<ZZ> > T;
+    Vec<ZZ> x;
+    x.SetLength(n.length());
+    for(i=0; i<n.length(); i++) {
+        abs(x[i], n[i]);
+        if(IsZero(x[i])) set(x[i]);
+    }
+    s.SetLength(n.length());
+    if(n.length()==0) return;
+    ProductTree(T,x);
+    l = T.length()-1;
+    rem(T[l][0], P[P.length()-1][0], T[l][0]);
+    for(l--; l>=0; l--)// remainder tree
+        for(i=0; i<T[l].length(); i++) rem(T[l][i], T[l+1][i/2], T[l][i]);
+    for(i=0; i<n.length(); i++) {// gcd(x, (P mod x)^(2^j) mod x), 2^j >= bits(x)
+        for(j=0; (1L<<j) < NumBits(x[i]); j++) SqrMod(T[0][i], T[0][i], x[i]);
+        GCD(s[i], T[0][i], x[i]);
+        if(IsZero(n[i])) clear(s[i]);
     }
 }
 
@@ -83,28 +206,33 @@ void factor(Vec<Pair<ZZ, long> >& f, const ZZ& n)
 //       vector of (prime, exponent) pair
 //       in increasing order of primes
 {
-    long i(0),j,p;
-    ZZ m;
+    const Vec<Vec<ZZ> >& T(PrimeTree());
+    ZZ g,m;
     abs(m,n);
     f.SetLength(0);
     if(IsZero(m) || IsOne(m)) return;
-    if(j = MakeOdd(m)) {
-        f.SetLength(1);
-        f[0].a = 2;
-        f[0].b = j;
-        if(IsOne(m)) return;
-        i++;
-    }
-    PrimeSeq ps;
-    ps.reset(3);
-    while((p = ps.next()) <= TRYDIV_BOUND) {
-        for(j=0; divide(m,m,p); j++);
-        if(j==0) continue;
-        f.SetLength(i+1);
-        f[i].a = p;
-        f[i].b = j;
-        if(IsOne(m)) return;
-        i++;
+    GCD(g, m, T[T.length()-1][0]);// primes up to TRYDIV_BOUND
+    trial(f,m,g);
+    if(!IsOne(m)) factor_(f,m);
+}
+
+void factor(Vec<Vec<Pair<ZZ, long> > >& f, const Vec<ZZ>& n)
+// input:
+//   n = vector of integers
+// output:
+//   f[i] = prime factorization of |n[i]| as factor(f[i],n[i])
+//       with small primes of all n[i] found at once by SmoothPart
+{
+    long i;
+    ZZ m;
+    Vec<ZZ> s;
+    SmoothPart(s,n);
+    f.SetLength(n.length());
+    for(i=0; i<n.length(); i++) {
+        abs(m,n[i]);
+        f[i].SetLength(0);
+        if(IsZero(m) || IsOne(m)) continue;
+        trial(f[i],m,s[i]);
+        if(!IsOne(m)) factor_(f[i],m);
     }
-    factor_(f,m);
-}
\ No newline at end of file
+}
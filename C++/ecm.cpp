@@ -0,0 +1,169 @@
+// uses NTL
+//   http://www.shoup.net/ntl
+
+#include<atomic>
+#include<mutex>
+#include<NTL/ZZ_p.h>
+#include<NTL/BasicThreadPool.h>
+using namespace NTL;
+
+#define ECM_D      210 // giant step of stage 2
+#define ECM_B2     100 // B2 = ECM_B2 * B1
+#define ECM_SIGMA  6 // parameter of first curve
+#define ECM_LEVELS 9
+
+static const long ECM_TABLE[ECM_LEVELS][3] = {
+// digits of factor, B1, number of curves
+    {10, 360, 8},
+    {15, 2000, 25},
+    {20, 11000, 90},
+    {25, 50000, 300},
+    {30, 250000, 700},
+    {35, 1000000, 1800},
+    {40, 3000000, 5100},
+    {45, 11000000, 10600},
+    {50, 43000000, 19300}
+};
+
+struct ECMPoint {// (x:z) on montgomery curve by^2 = x^3 + ax^2 + x
+    ZZ_p x,z;
+};
+
+static void dbl(ECMPoint& R, const ECMPoint& P, const ZZ_p& a24)
+{// R = 2P where a24 = (a+2)/4
+    ZZ_p s,t,u;
+    add(s, P.x, P.z); sqr(s,s);
+    sub(t, P.x, P.z); sqr(t,t);
+    sub(u,s,t);
+    mul(R.x,s,t);
+    mul(s,a24,u); s += t;
+    mul(R.z,u,s);
+}
+
+static void add(ECMPoint& R, const ECMPoint& P, const ECMPoint& Q, const ECMPoint& D)
+{// R = P+Q where D = P-Q
+    ZZ_p s,t,u,v;
+    sub(s, P.x, P.z); add(t, Q.x, Q.z); mul(u,s,t);
+    add(s, P.x, P.z); sub(t, Q.x, Q.z); mul(v,s,t);
+    add(s,u,v); sqr(s,s); s *= D.z;
+    sub(t,u,v); sqr(t,t); t *= D.x;
+    R.x = s;
+    R.z = t;
+}
+
+static void mul(ECMPoint& S, ECMPoint& T, const ECMPoint& P, unsigned long k, const ZZ_p& a24)
+{// S = kP and T = (k+1)P (k>0) by montgomery ladder
+    long i;
+    ECMPoint D(P);
+    S = D;
+    dbl(T,D,a24);
+    for(i = 62 - __builtin_clzl(k); i>=0; i--) {
+        if(k>>i & 1) { add(S,T,S,D); dbl(T,T,a24); }
+        else { add(T,T,S,D); dbl(S,S,a24); }
+    }
+}
+
+static long curve(ZZ& d, const ZZ& n, long sigma, long B1, long B2)
+// d = gcd found by one curve given by Suyama's parameter sigma
+// return 1 if 1 < d < n
+{
+    long i,p,q,v,w,m;
+    ZZ_p a24,s,t,u,g;
+    ECMPoint Q,T,G,S;
+    Vec<ECMPoint> B;
+    conv(u, sigma); sqr(u,u); u -= 5;// x = u^3, z = v^3
+    conv(t, 4*sigma);// v
+    sub(s,t,u); power(a24,s,3);
+    mul(s,u,3); s += t; a24 *= s;
+    power(Q.x,u,3);
+    power(Q.z,t,3);
+    mul(s, Q.x, t); s *= 16;
+    GCD(d, rep(s), n);
+    if(!IsOne(d)) return d<n;
+    a24 /= s;
+    PrimeSeq ps;
+    for(p=ps.next(); p>0 && p<=B1; p=ps.next()) {// stage 1
+        for(q=p; q<=B1/p; q*=p);
+        mul(Q,T,Q,q,a24);
+    }
+    GCD(d, rep(Q.z), n);
+    if(!IsOne(d)) return d<n;
+    B.SetLength(ECM_D/2 + 1);// stage 2 by baby and giant steps
+    B[1] = Q;
+    dbl(T,Q,a24);
+    add(B[3],T,Q,Q);
+    for(i=5; i<=ECM_D/2; i+=2) add(B[i], B[i-2], T, B[i-4]);
+    mul(G,T,Q,ECM_D,a24);
+    ps.reset(B1+1);
+    p = ps.next();
+    v = (p + ECM_D/2)/ECM_D;
+    mul(S,T,G,v,a24);// S = vG, T = (v+1)G
+    set(g);
+    for(m=0; p>0 && p<=B2; p=ps.next()) {// p = v*ECM_D +- i
+        w = (p + ECM_D/2)/ECM_D;
+        for(; v<w; v++, m=0) {
+            add(Q,T,G,S);
+            S = T;
+            T = Q;
+        }
+        i = p - v*ECM_D;
+        if(i<0) i = -i;
+        if(m>>(i>>1) & 1) continue;// pair of v*ECM_D-i done
+        m |= 1L<<(i>>1);
+        mul(s, S.x, B[i].z);
+        mul(t, B[i].x, S.z);
+        s -= t;
+        g *= s;
+    }
+    GCD(d, rep(g), n);
+    return !IsOne(d) && d<n;
+}
+
+long ecm(ZZ& d, const ZZ& n, long D, long& L)
+// input:
+//   n = odd composite integer, not prime power
+//   D = decimal digits of factors to look for
+//       (0 if chosen by size of n)
+//   L = first level of ECM_TABLE to run
+// output:
+//   d = divisor of n, 1 < d < n
+//       by elliptic curve method with stage 2
+//       curves run in parallel
+//   L = first level not run, so that next call continues from it
+//       with curves not tried before
+// return:
+//   0 if successful, -1 if failure
+// reference:
+//   P. L. Montgomery "Speeding the Pollard and Elliptic Curve
+//     Methods of Factorization" Mathematics of Computation 48 (1987) 243
+//   R. Crandall and C. Pomerance
+//     "Prime Numbers: A Computational Perspective"
+//     2nd edition (Springer) section 7.4
+{
+    ZZ m;
+    if(&d==&n) return ecm(d,m=n,D,L);
+    long i,l,s(ECM_SIGMA);
+    for(i=0; i<L && i<ECM_LEVELS; i++) s += ECM_TABLE[i][2];
+    if(D<=0) D = NumBits(n)/10 - 3;
+    l = long(NumBits(n)*log10(2.)/2);// digits of sqrt(n)
+    if(D>l) D = l;
+    ZZ_pContext ctx(n);
+    std::mutex mu;
+    std::atomic<long> done(0);
+    for(i=L; i<ECM_LEVELS && ECM_TABLE[i][0] <= D && !done; i++) {
+        long B1(ECM_TABLE[i][1]), C(ECM_TABLE[i][2]);
+        NTL_EXEC_RANGE(C, first, last)
+            ZZ_pPush push(ctx);
+            ZZ g;
+            for(long j=first; j<last && !done; j++) {
+                if(!curve(g, n, s+j, B1, ECM_B2*B1)) continue;
+                std::lock_guard<std::mutex> lk(mu);
+                if(!done || g<d) d = g;
+                done = 1;
+            }
+        NTL_EXEC_RANGE_END
+        s += C;
+    }
+    if(i>L) L = i;
+    return (done ? 0 : -1);
+}
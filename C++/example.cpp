@@ -38,4 +38,11 @@ main() {
         PowerMod(b,b,4,p);
         std::cout << (a==b) << std::endl;
     }
+
+    // Fixed base power table (base == 0 mod p)
+    GGModulus M(p);
+    GGPowerTable T;
+    build(T,p,M,NumBits(n));
+    PowerMod(b,T,n);
+    std::cout << IsZero(b) << std::endl;
 }
\ No newline at end of file
@@ -2,9 +2,9 @@
 #include<fstream>
 using namespace NTL;
 
-void ResSymb_(GG& s, const GG& a, const GG& p) {
-    ZZ n;
-    norm(n,p); n--; n>>=2;
+void ResSymb_(GG& s, const GG& a, const GGModulus& p) {
+    ZZ n(p.n);
+    n--; n>>=2;
     PowerMod(s,a,n,p);
 }
 
@@ -12,25 +12,31 @@ main() {
     long i,j,k,l,n(100),M(10),N(10),MN(M*N);
     double l1(100),l2(1000);
     std::ofstream f("fig1.txt");
-    double t1,t2,s,dl(pow(l2/l1, 1./n));
-    GG p,a,b;
+    double t1,t2,t3,s,dl(pow(l2/l1, 1./n));
+    GG p,a,b,c;
+    GGModulus P;
     for(i=0; i<=n; i++) {
         l = (long)round(l1 * pow(dl,i));
-        t1 = t2 = 0;
+        t1 = t2 = t3 = 0;
         for(j=0; j<M; j++) {
             GenPrime(p,l);
+            build(P,p,1);
             for(k=0; k<N; k++) {
                 RandomLen(a,l); a %= p;
-                s = GetTime(); ResSymb_(b,a,p);
+                s = GetTime(); ResSymb_(b,a,P);
                 t1 += GetTime() - s;
+                s = GetTime(); BinResSymb(c,a,p);
+                t3 += GetTime() - s;
                 s = GetTime(); ResSymb(a,a,p);
                 t2 += GetTime() - s;
                 if(a!=b) std::cout << "a!=b" << std::endl;
+                if(c!=b) std::cout << "c!=b" << std::endl;
             }
         }
         t1 /= MN;
         t2 /= MN;
-        f << l << ' ' << t1 << ' ' << t2 << std::endl;
-        std::cout << l << ' ' << t1 << ' ' << t2 << std::endl;
+        t3 /= MN;
+        f << l << ' ' << t1 << ' ' << t2 << ' ' << t3 << std::endl;
+        std::cout << l << ' ' << t1 << ' ' << t2 << ' ' << t3 << std::endl;
     }
 }
@@ -0,0 +1,51 @@
+#include "GGT.h"
+#include<fstream>
+using namespace NTL;
+
+template<class T>
+double ResSymbTime(const Vec<GG>& a, const GG& p) {// seconds for all a
+    long i;
+    double s;
+    Vec<GGT<T> > x;
+    GGT<T> y,z;
+    x.SetLength(a.length());
+    for(i=0; i<a.length(); i++) conv(x[i], a[i]);
+    conv(y,p);
+    s = GetTime();
+    for(i=0; i<x.length(); i++) ResSymb(z,x[i],y);
+    return GetTime() - s;
+}
+
+main() {
+    long i,k,l,M(100),N(1000),MN(M*N);
+    std::ofstream f("fig2.txt");
+    double t1,t2,t3;
+    GG p;
+    Vec<GG> a;
+    a.SetLength(N);
+    for(l=8; l<=120; l+=4) {
+        t1 = t2 = t3 = 0;
+        for(i=0; i<M; i++) {
+            GenPrime(p,l);
+            for(k=0; k<N; k++) {
+                RandomLen(a[k],l/2); a[k] %= p;
+            }
+            t1 += ResSymbTime<ZZ>(a,p);
+            t2 += ResSymbTime<__int128>(a,p);
+            if(l <= 2*GGT_LONG_BITS) t3 += ResSymbTime<long>(a,p);
+        }
+        t1 /= MN;
+        t2 /= MN;
+        t3 /= MN;
+        f << l << ' ' << t1 << ' ' << t2 << ' ';
+        std::cout << l << ' ' << t1 << ' ' << t2 << ' ';
+        if(l <= 2*GGT_LONG_BITS) {
+            f << t3 << std::endl;
+            std::cout << t3 << std::endl;
+        }
+        else {
+            f << '?' << std::endl;
+            std::cout << '?' << std::endl;
+        }
+    }
+}
@@ -0,0 +1,10 @@
+reset
+set terminal postscript eps enhanced 24
+set output 'fig2.eps'
+set xlabel 'length of N({/Symbol p})  / bit'
+set ylabel 'time to compute [{/Symbol a}|{/Symbol p}]  / {/Symbol m}sec'
+set key left Left reverse
+plot \
+	'fig2.txt' u 1:($2/0.000001) t 'ZZ' w l lt 1,\
+	'fig2.txt' u 1:($3/0.000001) t '\_\_int128' w l lt 2,\
+	'fig2.txt' u 1:($4/0.000001) t 'long' w l lt 3
@@ -0,0 +1,39 @@
+#include "GG.h"
+#include<NTL/BasicThreadPool.h>
+#include<fstream>
+using namespace NTL;
+
+main() {
+    long i,j,k,l,n(100),M(10),N(1000),MN(M*N),T(4);
+    double l1(10),l2(1000);
+    std::ofstream f("fig3.txt");
+    double t1,t2,t3,s,dl(pow(l2/l1, 1./n));
+    GG p;
+    Vec<GG> a,b;
+    a.SetLength(N);
+    b.SetLength(N);
+    for(i=0; i<=n; i++) {
+        l = (long)round(l1 * pow(dl,i));
+        t1 = t2 = t3 = 0;
+        for(j=0; j<M; j++) {
+            GenPrime(p,l);
+            for(k=0; k<N; k++) {
+                RandomLen(a[k],l); a[k] %= p;
+            }
+            s = GetWallTime();
+            for(k=0; k<N; k++) ResSymb(b[k],a[k],p);
+            t1 += GetWallTime() - s;
+            SetNumThreads(1);
+            s = GetWallTime(); ResSymbBatch(b,a,p);
+            t2 += GetWallTime() - s;
+            SetNumThreads(T);
+            s = GetWallTime(); ResSymbBatch(b,a,p);
+            t3 += GetWallTime() - s;
+        }
+        t1 = MN/t1;// symbols per second
+        t2 = MN/t2;
+        t3 = MN/t3;
+        f << l << ' ' << t1 << ' ' << t2 << ' ' << t3 << std::endl;
+        std::cout << l << ' ' << t1 << ' ' << t2 << ' ' << t3 << std::endl;
+    }
+}
@@ -0,0 +1,11 @@
+reset
+set terminal postscript eps enhanced 24
+set output 'fig3.eps'
+set xlabel 'length of N({/Symbol p})  / bit'
+set ylabel 'symbols / sec'
+set logscale xy
+set key right Right
+plot \
+	'fig3.txt' u 1:2 t 'ResSymb' w l lt 1,\
+	'fig3.txt' u 1:3 t 'ResSymbBatch' w l lt 2,\
+	'fig3.txt' u 1:4 t 'ResSymbBatch, 4 threads' w l lt 3
@@ -0,0 +1,30 @@
+#include "mpqs.h"
+#include<fstream>
+using namespace NTL;
+
+main() {
+    long j,l,M(3);
+    std::ofstream f("fig4.txt");
+    double t1,t2,m1,m2;
+    ZZ p,q,n,d;
+    MPQSParam P1,P2;
+    MPQSStats s;
+    P1.la = 1;// dense
+    P2.la = 2;// block lanczos
+    for(l=100; l<=180; l+=10) {
+        t1 = t2 = m1 = m2 = 0;
+        for(j=0; j<M; j++) {
+            GenPrime(p,l/2);
+            GenPrime(q,l-l/2);
+            mul(n,p,q);
+            if(mpqs(d,n,P1,s)) std::cout << "failure" << std::endl;
+            t1 += s.la_time; m1 += s.la_bytes;
+            if(mpqs(d,n,P2,s)) std::cout << "failure" << std::endl;
+            t2 += s.la_time; m2 += s.la_bytes;
+        }
+        t1 /= M; t2 /= M;
+        m1 /= M; m2 /= M;
+        f << l << ' ' << t1 << ' ' << t2 << ' ' << m1 << ' ' << m2 << std::endl;
+        std::cout << l << ' ' << t1 << ' ' << t2 << ' ' << m1 << ' ' << m2 << std::endl;
+    }
+}
@@ -0,0 +1,15 @@
+reset
+set terminal postscript eps enhanced 24
+set output 'fig4a.eps'
+set xlabel 'length of n  / bit'
+set ylabel 'time for linear algebra  / sec'
+set logscale y
+set key left Left reverse
+plot \
+	'fig4.txt' u 1:2 t 'dense' w l lt 2,\
+	'fig4.txt' u 1:3 t 'block lanczos' w l lt 1
+set output 'fig4b.eps'
+set ylabel 'memory for linear algebra  / MB'
+plot \
+	'fig4.txt' u 1:($4/1e6) t 'dense' w l lt 2,\
+	'fig4.txt' u 1:($5/1e6) t 'block lanczos' w l lt 1
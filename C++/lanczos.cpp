@@ -0,0 +1,354 @@
+// uses NTL
+//   http://www.shoup.net/ntl
+
+#include "mpqs.h"
+using namespace NTL;
+
+#if NTL_BITS_PER_LONG != 64
+#error "block lanczos assumes 64-bit unsigned long"
+#endif
+
+#define LANCZOS_TRIAL  4 // number of random starts before failure
+#define LANCZOS_EXCESS 96 // rows - columns kept after filtering
+
+typedef unsigned long u64;
+typedef Vec<Vec<long> > SpMat;// rows of sparse matrix over GF(2)
+
+static void MulSym(Vec<u64>& y, const Vec<u64>& x, const SpMat& A, Vec<u64>& t)
+// y = A * A^T * x
+// t = scratch of length (number of columns)
+{
+    long i,j;
+    for(j=0; j<t.length(); j++) t[j] = 0;
+    for(i=0; i<A.length(); i++)
+        for(j=0; j<A[i].length(); j++) t[A[i][j]] ^= x[i];
+    for(i=0; i<A.length(); i++) {
+        u64 s(0);
+        for(j=0; j<A[i].length(); j++) s ^= t[A[i][j]];
+        y[i] = s;
+    }
+}
+
+static void MulTrans(Vec<u64>& t, const Vec<u64>& x, const SpMat& A)
+// t = A^T * x (t must have length of number of columns)
+{
+    long i,j;
+    for(j=0; j<t.length(); j++) t[j] = 0;
+    for(i=0; i<A.length(); i++)
+        for(j=0; j<A[i].length(); j++) t[A[i][j]] ^= x[i];
+}
+
+static void InnerProd(u64 *c, const Vec<u64>& x, const Vec<u64>& y)
+// c = x^T * y (64x64 matrix, c[k] = row k)
+{
+    long i,j,k;
+    u64 T[8][256];
+    for(k=0; k<8; k++)
+        for(j=0; j<256; j++) T[k][j] = 0;
+    for(i=0; i<x.length(); i++) {
+        u64 a(x[i]);
+        for(k=0; k<8; k++, a>>=8) T[k][a&255] ^= y[i];
+    }
+    for(k=0; k<8; k++)
+        for(j=0; j<8; j++) {
+            u64 s(0);
+            for(i=0; i<256; i++) if(i>>j & 1) s ^= T[k][i];
+            c[8*k+j] = s;
+        }
+}
+
+static void MulAcc(Vec<u64>& y, const Vec<u64>& x, const u64 *c)
+// y += x * c where c is 64x64 matrix
+{
+    long i,j,k;
+    u64 T[8][256];
+    for(k=0; k<8; k++) {
+        T[k][0] = 0;
+        for(j=1; j<256; j++) T[k][j] = T[k][j&(j-1)] ^ c[8*k + __builtin_ctzl(j)];
+    }
+    for(i=0; i<x.length(); i++) {
+        u64 a(x[i]),s(0);
+        for(k=0; k<8; k++, a>>=8) s ^= T[k][a&255];
+        y[i] ^= s;
+    }
+}
+
+static void Mul64(u64 *c, const u64 *a, const u64 *b)
+// c = a * b for 64x64 matrices (c may alias a or b)
+{
+    long i,k;
+    u64 d[64];
+    for(i=0; i<64; i++) {
+        u64 s(0),w(a[i]);
+        for(k=0; w; k++, w>>=1) if(w&1) s ^= b[k];
+        d[i] = s;
+    }
+    for(i=0; i<64; i++) c[i] = d[i];
+}
+
+static long Invert(u64 *w, long *s, const u64 *t, const long *s1, long n1)
+// find largest invertible submatrix of 64x64 matrix t,
+//   preferring columns not in s1[0..n1-1],
+// set w = its inverse (padded with zeros)
+//   and s = list of chosen columns
+// return number of chosen columns, or -1 on failure
+// reference: P. L. Montgomery
+//   "A Block Lanczos Algorithm for Finding Dependencies over GF(2)"
+//   EUROCRYPT '95, LNCS 921 (1995) 106
+{
+    long i,j,n;
+    u64 M[64][2],m,u;
+    for(i=0; i<64; i++) { M[i][0] = t[i]; M[i][1] = 1UL<<i; }
+    for(i=m=0; i<n1; i++) m |= 1UL<<s1[i];
+    for(i=j=0; i<64; i++) if(!(m>>i & 1)) s[j++] = i;
+    for(i=0; i<n1; i++) s[j++] = s1[i];
+    for(i=n=0; i<64; i++) {
+        u64 *r(M[s[i]]);
+        m = 1UL<<s[i];
+        for(j=i; j<64; j++) {
+            u64 *q(M[s[j]]);
+            if(q[0] & m) {
+                u=q[0]; q[0]=r[0]; r[0]=u;
+                u=q[1]; q[1]=r[1]; r[1]=u;
+                break;
+            }
+        }
+        if(j<64) {
+            for(j=0; j<64; j++) {
+                u64 *q(M[s[j]]);
+                if(q!=r && (q[0] & m)) { q[0] ^= r[0]; q[1] ^= r[1]; }
+            }
+            s[n++] = s[i];
+            continue;
+        }
+        for(j=i; j<64; j++) {
+            u64 *q(M[s[j]]);
+            if(q[1] & m) {
+                u=q[0]; q[0]=r[0]; r[0]=u;
+                u=q[1]; q[1]=r[1]; r[1]=u;
+                break;
+            }
+        }
+        if(j==64) return -1;
+        for(j=0; j<64; j++) {
+            u64 *q(M[s[j]]);
+            if(q!=r && (q[1] & m)) { q[0] ^= r[0]; q[1] ^= r[1]; }
+        }
+        r[0] = r[1] = 0;
+    }
+    for(i=0; i<64; i++) w[i] = M[i][1];
+    return n;
+}
+
+static long Combine(Vec<u64>& z, const Vec<u64>& x, const Vec<u64>& v, const SpMat& A, long K)
+// find combinations of 128 columns of x and v
+//   which are in null space of A^T,
+// and store up to 64 nonzero ones in bits of z
+// return number of vectors found
+{
+    long i,j,k,c,n((K+63)>>6);
+    Vec<u64> ax,av,cb[128];
+    u64 cm[128][2];
+    ax.SetLength(K);
+    av.SetLength(K);
+    MulTrans(ax,x,A);
+    MulTrans(av,v,A);
+    for(c=0; c<128; c++) {
+        cb[c].SetLength(n);
+        for(i=0; i<n; i++) cb[c][i] = 0;
+        cm[c][0] = cm[c][1] = 0;
+        cm[c][c>>6] = 1UL<<(c&63);
+    }
+    for(i=0; i<K; i++)
+        for(c=0; c<128; c++)
+            if((c<64 ? ax[i]>>c : av[i]>>(c-64)) & 1)
+                cb[c][i>>6] |= 1UL<<(i&63);
+    z.SetLength(x.length());
+    for(i=0; i<z.length(); i++) z[i] = 0;
+    for(c=k=0; c<128 && k<64; c++) {
+        for(i=0; i<n && cb[c][i]==0; i++);
+        if(i<n) {// pivot at lowest bit of column c
+            u64 m(cb[c][i] & -cb[c][i]);
+            for(j=c+1; j<128; j++) {
+                if(!(cb[j][i] & m)) continue;
+                for(long h=i; h<n; h++) cb[j][h] ^= cb[c][h];
+                cm[j][0] ^= cm[c][0];
+                cm[j][1] ^= cm[c][1];
+            }
+            continue;
+        }
+        u64 s(0);
+        for(i=0; i<x.length(); i++) {
+            u64 b((__builtin_parityl(x[i] & cm[c][0]) ^
+                   __builtin_parityl(v[i] & cm[c][1])));
+            z[i] |= b<<k;
+            s |= b;
+        }
+        if(s) k++;
+    }
+    return k;
+}
+
+static long Lanczos(Vec<u64>& z, const SpMat& A, long K)
+// one run of block lanczos on A * A^T from a random start
+// return number of dependencies in z, or -1 on failure
+{
+    long i,j,n(A.length()),d0,d1(64),s0[64],s1[64];
+    Vec<u64> x,v[3],vn,v0,t;
+    u64 w0[64],w1[64],w2[64],va0[64],va1[64],vb0[64],vb1[64];
+    u64 D[64],E[64],F[64],G[64],m0,m1(~0UL);
+    x.SetLength(n); vn.SetLength(n); v0.SetLength(n);
+    for(j=0; j<3; j++) {
+        v[j].SetLength(n);
+        for(i=0; i<n; i++) v[j][i] = 0;
+    }
+    t.SetLength(K);
+    for(i=0; i<n; i++) x[i] = RandomWord();
+    MulSym(v[0], x, A, t);
+    v0 = v[0];
+    for(i=0; i<64; i++) {
+        s1[i] = i;
+        w1[i] = w2[i] = va1[i] = vb1[i] = 0;
+    }
+    for(long it=0;; it++) {
+        if(it > n/60 + 100) return -1;// no convergence
+        MulSym(vn, v[0], A, t);
+        InnerProd(va0, v[0], vn);// v^T A v
+        InnerProd(vb0, vn, vn);// v^T A^2 v
+        for(i=0; i<64 && va0[i]==0; i++);
+        if(i==64) break;
+        if((d0 = Invert(w0, s0, va0, s1, d1)) <= 0) return -1;
+        for(i=m0=0; i<d0; i++) m0 |= 1UL<<s0[i];
+
+        for(i=0; i<64; i++) D[i] = (vb0[i] & m0) ^ va0[i];
+        Mul64(D, w0, D);
+        for(i=0; i<64; i++) D[i] ^= 1UL<<i;
+        Mul64(E, w1, va0);
+        for(i=0; i<64; i++) E[i] &= m0;
+        Mul64(F, va1, w1);
+        for(i=0; i<64; i++) F[i] ^= 1UL<<i;
+        Mul64(F, w2, F);
+        for(i=0; i<64; i++) G[i] = ((vb1[i] & m1) ^ va1[i]) & m0;
+        Mul64(F, F, G);
+
+        for(i=0; i<n; i++) vn[i] &= m0;
+        MulAcc(vn, v[0], D);
+        MulAcc(vn, v[1], E);
+        MulAcc(vn, v[2], F);
+
+        InnerProd(G, v[0], v0);// x += v W^-1 v^T v0
+        Mul64(G, w0, G);
+        MulAcc(x, v[0], G);
+
+        swap(v[2], v[1]);
+        swap(v[1], v[0]);
+        swap(v[0], vn);
+        for(i=0; i<64; i++) {
+            w2[i] = w1[i]; w1[i] = w0[i];
+            va1[i] = va0[i]; vb1[i] = vb0[i];
+            s1[i] = s0[i];
+        }
+        m1 = m0;
+        d1 = d0;
+    }
+    return Combine(z, x, v[0], A, K);
+}
+
+static void Filter(Vec<long>& r, Vec<long>& c, const SpMat& A, long K)
+// r = indices of rows of A which may be in a dependency
+//   after removing singletons and excess cliques
+// c[j] = new index of column j (-1 if unused)
+{
+    long i,j,k,l,m,n(A.length());
+    Vec<long> w,f,g,h;
+    Vec<char> a;
+    w.SetLength(K);
+    a.SetLength(n);
+    for(j=0; j<K; j++) w[j] = 0;
+    for(i=0; i<n; i++) {
+        a[i] = 1;
+        for(j=0; j<A[i].length(); j++) w[A[i][j]]++;
+    }
+    for(;;) {
+        do {// remove singletons
+            for(i=l=0; i<n; i++) {
+                if(!a[i]) continue;
+                for(j=0; j<A[i].length() && w[A[i][j]]!=1; j++);
+                if(j==A[i].length()) continue;
+                for(j=0; j<A[i].length(); j++) w[A[i][j]]--;
+                a[i] = 0;
+                l++;
+            }
+        } while(l);
+        for(i=l=0; i<n; i++) l += a[i];
+        for(j=0; j<K; j++) if(w[j]) l--;
+        if(l <= LANCZOS_EXCESS) break;
+        // remove largest cliques (rows connected by columns of weight 2)
+        f.SetLength(n);
+        for(i=0; i<n; i++) f[i] = i;
+        g.SetLength(K);
+        for(j=0; j<K; j++) g[j] = -1;
+        for(i=0; i<n; i++) {
+            if(!a[i]) continue;
+            for(j=0; j<A[i].length(); j++) {
+                if(w[k = A[i][j]] != 2) continue;
+                if(g[k]<0) { g[k] = i; continue; }
+                for(m=g[k]; f[m]!=m; m=f[m]);
+                for(k=i; f[k]!=k; k=f[k]);
+                if(k!=m) f[k] = m;
+            }
+        }
+        h.SetLength(n);
+        for(i=0; i<n; i++) h[i] = 0;
+        for(i=0; i<n; i++) {
+            if(!a[i]) continue;
+            for(k=i; f[k]!=k; k=f[k]);
+            h[f[i] = k]++;
+        }
+        for(m=0; l > LANCZOS_EXCESS; l--, m++) {
+            for(i=k=0; i<n; i++) if(h[i] > h[k]) k=i;
+            if(h[k] == 0) break;
+            h[k] = 0;
+            for(i=0; i<n; i++) {
+                if(!a[i] || f[i]!=k) continue;
+                for(j=0; j<A[i].length(); j++) w[A[i][j]]--;
+                a[i] = 0;
+            }
+        }
+        if(m==0) break;
+    }
+    r.SetLength(0);
+    for(i=0; i<n; i++) if(a[i]) r.append(i);
+    c.SetLength(K);
+    for(j=k=0; j<K; j++) c[j] = (w[j] ? k++ : -1);
+}
+
+long BlockLanczos(Vec<unsigned long>& z, const Vec<Vec<long> >& A, long K,
+                  long *rows, long *cols)
+// find dependencies of rows of A (see mpqs.h)
+// singleton rows and excess cliques are removed before
+//   block lanczos iteration
+{
+    long i,j,k;
+    Vec<long> r,c;
+    SpMat B;
+    Vec<u64> y;
+    Filter(r,c,A,K);
+    B.SetLength(r.length());
+    for(i=0; i<r.length(); i++) {
+        const Vec<long>& a(A[r[i]]);
+        B[i].SetLength(a.length());
+        for(j=0; j<a.length(); j++) B[i][j] = c[a[j]];
+    }
+    for(j=k=0; j<K; j++) if(c[j]>=0) k++;
+    if(rows) *rows = B.length();
+    if(cols) *cols = k;
+    z.SetLength(A.length());
+    for(i=0; i<z.length(); i++) z[i] = 0;
+    if(B.length() <= k) return 0;
+    for(j=0; j<LANCZOS_TRIAL; j++)
+        if((i = Lanczos(y,B,k)) > 0) break;
+    if(i <= 0) return -1;
+    for(j=0; j<r.length(); j++) z[r[j]] = y[j];
+    return i;
+}
@@ -1,151 +1,710 @@
 // uses NTL
 //   http://www.shoup.net/ntl
 
+#include<algorithm>
+#include<unordered_map>
+#include<unordered_set>
+#include<cstring>
+#include<mutex>
+#include<atomic>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include<immintrin.h>
+#endif
 #include<NTL/vec_ZZ_p.h>
 #include<NTL/mat_GF2.h>
+#include<NTL/BasicThreadPool.h>
+#include "mpqs.h"
 using namespace NTL;
 
 #define MPQS_MAXLEN 180
 #define MPQS_BOUND  0.5
-#define MPQS_INTVL  1
+#define MPQS_INTVL  0.25
+#define MPQS_MINB   1000 // minimum bound of factor base
+#define MPQS_APRIME 2000 // typical size of primes in a
+#define MPQS_AWIN   0.7 // primes in a are chosen in exp(+-MPQS_AWIN) * typical size
+#define MPQS_ATRIAL 1000 // max trials to choose new a
+#define MPQS_MAXM   (1L<<24) // max of sieve interval
 #define MPQS_SIEV   1
 #define MPQS_EXTRA  10
+#define MPQS_BATCH  1 // values of a per thread in one batch
+#define MPQS_SPARSE 800 // use block lanczos if factor base is larger
+#define MPQS_BBITS  15 // sieve in blocks of 2^MPQS_BBITS bytes (L1 cache)
+#define MPQS_BLOCK  (1L<<MPQS_BBITS)
+#define MPQS_SMALLP 32 // primes below this are not sieved
+#define MPQS_KMAX   73 // max of multiplier
+#define MPQS_KSP    2000 // primes used in Knuth-Schroeppel function
+#define MPQS_LPMUL  32 // bound of large primes = MPQS_LPMUL * (bound of factor base)
+#define MPQS_LPT    0.3 // threshold is lowered by MPQS_LPT*log(bound of large primes)
+#define MPQS_DLPT   0.6 //   or by MPQS_DLPT*log(...) for double large primes
+#define MPQS_RHO_STEPS (1<<16) // max iterations of rho for double large primes
 
 long Jacobi(long, long);
 long SqrRootMod(long, long);
+unsigned long brent_rho(unsigned long, long);
+
+struct MPQS {// factor base and sieve parameters
+    ZZ n;// number to be factored (times multiplier)
+    long K,M,U,T;// size of F, sieve interval [-M,M], U=2M+1, threshold
+    long J1,J2;// F[J1] >= MPQS_SMALLP, F[J2] >= MPQS_BLOCK (first indices)
+    long P;// number of polynomials sieved
+    long lp;// number of large primes allowed in one relation
+    long L,L2;// bound of large primes and of their product
+    Vec<long> F,S;// primes p such that (n/p)=1 or p|n, and sqrt(n) mod p
+    Vec<char> LF;// log_2(p)
+};
+
+struct MPQSRel {// relation u^2 == L[0] * L[1] * prod F[e[i]] (mod n)
+    ZZ u;//   where F[K] = -1
+    Vec<long> e;// indices of F with multiplicity
+    long L[2];// large primes, 1 if none
+};
+
+struct MPQSExp {// sparse exponent vectors stored in one array
+    Vec<unsigned int> x;// pairs (index in FZ, exponent) of i-th vector
+    Vec<long> o;//   are x[o[i]..o[i+1]-1], sorted by index
+};
+
+struct MPQSPart {// partial relation, or edge of graph of large primes
+    ZZ_p u;// exponent vector is in MPQSGraph::X
+    long v[2];// vertices of L[0] and L[1]
+};
+
+struct MPQSA {// generator of coefficients a of polynomials
+    long s;// number of primes in a
+    long lo,hi;// s-1 primes are chosen from F[lo..hi-1]
+    double lA;// log of target size of a
+    unsigned long x;// state of random numbers
+    std::unordered_set<unsigned long> used;// a mod 2^64 used before
+};
+
+struct MPQSGraph {// spanning forest of partial relations
+    std::unordered_map<long,long> V;// large prime -> vertex
+    Vec<long> fz;// index of large prime in FZ (-1 for vertex 0 = prime 1)
+    Vec<long> up,ue,dep;// parent, edge to parent, depth in tree
+    Vec<long> uf,sz;// union-find and size of tree
+    Vec<Vec<long> > adj;// edges at vertex
+    Vec<MPQSPart> E;// edges
+    MPQSExp X;// exponent vectors of edges
+};
+
+static void append(MPQSExp& X, Vec<long>& c)
+{// append exponent vector of indices c with multiplicity (c is sorted on exit)
+    long i,j,n(c.length());
+    if(X.o.length()==0) X.o.append(0);
+    std::sort(c.elts(), c.elts()+n);
+    for(i=0; i<n; i=j) {
+        for(j=i+1; j<n && c[j]==c[i]; j++);
+        X.x.append(c[i]);
+        X.x.append(j-i);
+    }
+    X.o.append(X.x.length());
+}
+
+static long find(Vec<long>& uf, long v)
+{// root of v in union-find
+    while(uf[v]!=v) v = uf[v] = uf[uf[v]];
+    return v;
+}
+
+static long vertex(MPQSGraph& G, long L, vec_ZZ_p& FZ)
+{// vertex of large prime L, added to G and FZ if new
+    if(L==1 && G.fz.length()) return 0;
+    std::unordered_map<long,long>::iterator i(G.V.find(L));
+    if(i!=G.V.end()) return i->second;
+    long v(G.fz.length());
+    G.V[L] = v;
+    if(L==1) G.fz.append(-1);
+    else {
+        G.fz.append(FZ.length());
+        FZ.SetLength(FZ.length()+1);
+        conv(FZ[FZ.length()-1], L);
+    }
+    G.up.append(-1); G.ue.append(-1); G.dep.append(0);
+    G.uf.append(v); G.sz.append(1);
+    G.adj.SetLength(v+1);
+    return v;
+}
+
+static long cycle(Vec<long>& c, MPQSGraph& G, long x)
+// add edge x to G
+// if x closes a cycle, set c = edges in the cycle and return 1
+// else link two trees by x and return 0
+{
+    long a(G.E[x].v[0]), b(G.E[x].v[1]), i,v,w,y;
+    long ra(find(G.uf,a)), rb(find(G.uf,b));
+    Vec<long> s;
+    c.SetLength(0);
+    if(ra==rb) {
+        while(a!=b) {
+            if(G.dep[a] < G.dep[b]) { v=a; a=b; b=v; }
+            c.append(G.ue[a]);
+            a = G.up[a];
+        }
+        c.append(x);
+        return 1;
+    }
+    if(G.sz[ra] < G.sz[rb]) { v=a; a=b; b=v; v=ra; ra=rb; rb=v; }
+    G.up[b] = a; G.ue[b] = x; G.dep[b] = G.dep[a]+1;
+    s.append(b);
+    while(s.length()) {// hang smaller tree at b under a
+        v = s[s.length()-1];
+        s.SetLength(s.length()-1);
+        for(i=0; i<G.adj[v].length(); i++) {
+            if((y = G.adj[v][i]) == G.ue[v]) continue;
+            w = (G.E[y].v[0]==v ? G.E[y].v[1] : G.E[y].v[0]);
+            G.up[w] = v; G.ue[w] = y; G.dep[w] = G.dep[v]+1;
+            s.append(w);
+        }
+    }
+    G.adj[a].append(x);
+    G.adj[b].append(x);
+    G.uf[rb] = ra;
+    G.sz[ra] += G.sz[rb];
+    return 0;
+}
+
+static unsigned long xorshift(unsigned long& x)
+{// next pseudo random number
+    x ^= x<<13; x ^= x>>7; x ^= x<<17;
+    return x;
+}
+
+static long NextA(Vec<long>& qa, MPQSA& A, const MPQS& Q)
+// qa = indices in F of primes of next a (not used before)
+// return 0 if no such a is found
+{
+    long i,j,k,l,h,t;
+    unsigned long w;
+    double r;
+    const Vec<long>& F(Q.F);
+    for(t=0; t<MPQS_ATRIAL; t++) {
+        qa.SetLength(0);
+        r = A.lA;
+        for(i=0; i<A.s; i++) {
+            if(i < A.s-1 || A.s==1)
+                j = A.lo + xorshift(A.x)%(A.hi - A.lo);
+            else {// prime nearest to the rest of target
+                for(k=1, h=Q.K-1; k<h;) {
+                    l = (k+h)>>1;
+                    if(log(F[l]) < r) k = l+1; else h = l;
+                }
+                j = k;
+                if(j>1 && r - log(F[j-1]) < log(F[j]) - r) j--;
+            }
+            for(k=0; k<i && qa[k]!=j; k++);
+            if(k<i || Q.S[j]==0) break;
+            qa.append(j);
+            r -= log(F[j]);
+        }
+        if(i < A.s) continue;
+        for(w=1, i=0; i<A.s; i++) w *= F[qa[i]];
+        if(A.used.insert(w).second) return 1;
+    }
+    return 0;
+}
+
+static void scan(Vec<long>& c, const unsigned char *v, long o, long n)
+// append to c indices o+i such that v[i] >= 0x80 for 0 <= i < n
+// v must be readable up to multiple of 32 bytes beyond n, filled by 0
+{
+    long i,m;
+#if defined(__AVX2__)
+    for(i=0; i<n; i+=32) {
+        m = (unsigned int)_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)(v+i)));
+        for(; m; m &= m-1) c.append(o + i + __builtin_ctzl(m));
+    }
+#elif defined(__SSE2__)
+    for(i=0; i<n; i+=16) {
+        m = _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(v+i)));
+        for(; m; m &= m-1) c.append(o + i + __builtin_ctzl(m));
+    }
+#else
+    unsigned long w;
+    for(i=0; i<n; i+=8) {
+        memcpy(&w, v+i, 8);
+        if((w & 0x8080808080808080UL) == 0) continue;
+        for(m=0; m<8; m++) if(v[i+m] & 0x80) c.append(o + i + m);
+    }
+#endif
+}
+
+static void sieve(Vec<MPQSRel>& R, const MPQS& Q, const Vec<long>& qa,
+                  Vec<unsigned char>& sv, Vec<Vec<unsigned int> >& bk)
+// R = relations found by polynomials a*s^2 + 2*b*s + c
+//   where a = prod F[qa[l]], b^2 == n (mod a), c = (b^2-n)/a
+//   for 2^(h-1) values of b (h = length of qa) in Gray code order
+//   and u = a*s+b for -M <= s <= M, so that u^2 - n = a*(a*s^2 + 2*b*s + c)
+//   with at most Q.lp large primes < Q.L
+// sv = sieve array of length U rounded up to multiple of MPQS_BLOCK
+// bk = buckets of primes >= MPQS_BLOCK for each block
+//      entry = (j << MPQS_BBITS) | (offset in block) for p = F[j]
+{
+    long i,j,k,l,m,o,p,r,s,t,L,h(qa.length());
+    const long K(Q.K),M(Q.M),U(Q.U);
+    const Vec<long>& F(Q.F);
+    const unsigned char T(0x80 - (Q.T < 0 ? 0 : Q.T > 0x80 ? 0x80 : Q.T));
+    unsigned char *z(sv.elts()), v;
+    ZZ a,b,c,d,u;
+    Vec<ZZ> B;
+    Vec<long> e,ia,r1,r2,o1,o2,cd,hi,hj;
+    Vec<Vec<long> > Bi;
+    R.SetLength(0);
+    set(a);
+    for(l=0; l<h; l++) a *= F[qa[l]];
+    B.SetLength(h);
+    for(l=0; l<h; l++) {// B[l]^2 == n (mod q_l), B[l] == 0 (mod a/q_l)
+        p = F[qa[l]];
+        div(d,a,p);
+        r = MulMod(Q.S[qa[l]], InvMod(rem(d,p),p), p);
+        mul(B[l],d,r);
+        b += B[l];
+    }
+    ia.SetLength(K);
+    r1.SetLength(K);
+    r2.SetLength(K);
+    o1.SetLength(K);
+    o2.SetLength(K);
+    Bi.SetLength(h);
+    for(l=0; l<h; l++) Bi[l].SetLength(K);
+    for(j=1; j<K; j++) {// roots of a*s^2 + 2*b*s + c mod p, shifted by M
+        p = F[j];
+        if((r = rem(a,p)) == 0 || Q.S[j] == 0) { ia[j] = 0; continue; }
+        ia[j] = r = InvMod(r,p);
+        m = rem(b,p);
+        r1[j] = (MulMod(SubMod(Q.S[j], m, p), r, p) + M)%p;
+        r2[j] = (MulMod(SubMod(p - Q.S[j], m, p), r, p) + M)%p;
+        for(l=0; l<h; l++) {// 2*B[l]/a mod p
+            m = rem(B[l],p);
+            Bi[l][j] = MulMod(AddMod(m,m,p), r, p);
+        }
+    }
+    for(k=0; k < 1L<<(h-1); k++) {
+        if(k) {// flip sign of B[l] in b
+            l = __builtin_ctzl(k);
+            LeftShift(d, B[l], 1);
+            if(k>>(l+1) & 1) {
+                b += d;
+                for(j=1; j<K; j++) if(ia[j]) {
+                    r1[j] = SubMod(r1[j], Bi[l][j], F[j]);
+                    r2[j] = SubMod(r2[j], Bi[l][j], F[j]);
+                }
+            }
+            else {
+                b -= d;
+                for(j=1; j<K; j++) if(ia[j]) {
+                    r1[j] = AddMod(r1[j], Bi[l][j], F[j]);
+                    r2[j] = AddMod(r2[j], Bi[l][j], F[j]);
+                }
+            }
+        }
+        sqr(c,b); c-=Q.n; c/=a;
+        for(l=0; l<bk.length(); l++) bk[l].SetLength(0);
+        for(j=Q.J2; j<K; j++) {// bucket sieve by large primes
+            if(ia[j]==0) continue;
+            p = F[j];
+            t = j<<MPQS_BBITS;
+            for(i=r1[j]; i<U; i+=p) bk[i>>MPQS_BBITS].append(t | (i & (MPQS_BLOCK-1)));
+            for(i=r2[j]; i<U; i+=p) bk[i>>MPQS_BBITS].append(t | (i & (MPQS_BLOCK-1)));
+        }
+        for(j=Q.J1; j<Q.J2; j++) { o1[j] = r1[j]; o2[j] = r2[j]; }
+        cd.SetLength(0);
+        hi.SetLength(0);
+        hj.SetLength(0);
+        for(o=0; o<U; o+=MPQS_BLOCK) {// sieve one block [o,m)
+            m = (o+MPQS_BLOCK < U ? o+MPQS_BLOCK : U);
+            memset(z+o, T, m-o);
+            for(j=Q.J1; j<Q.J2; j++) {
+                if(ia[j]==0) continue;
+                p = F[j];
+                v = Q.LF[j];
+                for(i=o1[j]; i<m; i+=p) z[i] += v;
+                o1[j] = i;
+                for(i=o2[j]; i<m; i+=p) z[i] += v;
+                o2[j] = i;
+            }
+            const Vec<unsigned int>& x(bk[o>>MPQS_BBITS]);
+            for(i=0; i<x.length(); i++)
+                z[o + (x[i] & (MPQS_BLOCK-1))] += Q.LF[x[i]>>MPQS_BBITS];
+            l = cd.length();
+            scan(cd, z+o, o, m-o);
+            if(l == cd.length()) continue;
+            for(i=0; i<x.length(); i++) {// resieve large primes at candidates
+                if((z[o + (x[i] & (MPQS_BLOCK-1))] & 0x80) == 0) continue;
+                hi.append(o + (x[i] & (MPQS_BLOCK-1)));
+                hj.append(x[i]>>MPQS_BBITS);
+            }
+        }
+        for(t=0; t<cd.length(); t++) {
+            s = (i = cd[t]) - M;
+            mul(u,a,s); u+=b;
+            add(d,u,b); d*=s; d+=c;
+            if(IsZero(d)) continue;
+            e.SetLength(0);
+            for(l=0; l<h; l++) e.append(qa[l]);
+            if(sign(d) < 0) e.append(K);
+            abs(d,d);
+            for(l=MakeOdd(d); l>0; l--) e.append(0);
+            for(j=1; j<Q.J2; j++) {// divide only if p hits s
+                if(ia[j]) {
+                    m = i%F[j];
+                    if(m!=r1[j] && m!=r2[j]) continue;
+                }
+                while(divide(d,d,F[j])) e.append(j);
+            }
+            for(l=0; l<h; l++)// a-primes are not sieved
+                if(qa[l] >= Q.J2) while(divide(d,d,F[qa[l]])) e.append(qa[l]);
+            for(l=0; l<hi.length(); l++) {
+                if(hi[l]!=i) continue;
+                j = hj[l];
+                while(divide(d,d,F[j])) e.append(j);
+            }
+            if(IsOne(d)) L = r = 1;
+            else if(d >= Q.L2) continue;
+            else if(d < Q.L) { L = to_long(d); r = 1; }// prime since d < B^2
+            else if(ProbPrime(d)) continue;
+            else if((L = brent_rho(r = to_long(d), MPQS_RHO_STEPS)) == 0) continue;
+            else if((r /= L) >= Q.L || L >= Q.L) continue;
+            R.SetLength(R.length()+1);
+            MPQSRel& S(R[R.length()-1]);
+            S.u = u;
+            S.e = e;
+            S.L[0] = L;
+            S.L[1] = r;
+        }
+    }
+}
+
+static long KnuthSchroeppel(double& f, const ZZ& n)
+// return multiplier k <= MPQS_KMAX (square free)
+//   which maximizes Knuth-Schroeppel function f(k,n)
+// reference:
+//   R. D. Silverman "The Multiple Polynomial Quadratic Sieve"
+//     Mathematics of Computation 48 (1987) 329
+{
+    long i,j,k,m,p;
+    double l;
+    Vec<long> nk;
+    Vec<double> fk;
+    for(k=1; k<=MPQS_KMAX; k++) {// square free k
+        for(i=2; i*i<=k && k%(i*i); i++);
+        if(i*i<=k) continue;
+        nk.append(k);
+        m = (k*rem(n,8))&7;
+        l = log(2.);
+        fk.append(-0.5*log(k) + (k&1 ? (m==1 ? 2*l : m==5 ? l : 0.5*l) : 0.5*l));
+    }
+    PrimeSeq ps;
+    ps.next();
+    while((p = ps.next()) < MPQS_KSP) {
+        m = rem(n,p);
+        l = log(p);
+        for(i=0; i<nk.length(); i++) {
+            if(nk[i]%p == 0) fk[i] += l/p;
+            else if(Jacobi(MulMod(nk[i]%p, m, p), p) > 0) fk[i] += 2*l/(p-1);
+        }
+    }
+    for(j=0, i=1; i<nk.length(); i++) if(fk[i] > fk[j]) j=i;
+    f = fk[j];
+    return nk[j];
+}
+
+static long split(Vec<ZZ>& f, const ZZ& d)
+// refine factors f by divisor d of their product
+// return 1 if all factors are probably prime
+{
+    long i,l(f.length());
+    ZZ g;
+    for(i=0; i<l; i++) {
+        GCD(g, f[i], d);
+        if(IsOne(g) || g==f[i]) continue;
+        f.SetLength(f.length()+1);
+        div(f[f.length()-1], f[i], g);
+        f[i] = g;
+    }
+    for(i=0; i<f.length(); i++) if(!ProbPrime(f[i])) return 0;
+    return 1;
+}
 
 long mpqs(ZZ& d, const ZZ& n)
+{
+    MPQSStats st;
+    return mpqs(d, n, MPQSParam(), st);
+}
+
+long mpqs(ZZ& d, const ZZ& n, const MPQSParam& par, MPQSStats& st)
+// input:
+//   n = odd integer, not prime power, n>2000
+// output:
+//   d = smallest factor found by mpqs(f,n,par,st)
+//   st = statistics
+// return:
+//   0 if successful, -1 or -2 if failure
+{
+    Vec<ZZ> f;
+    long r(mpqs(f, n, par, st));
+    if(r==0) d = f[0];
+    return r;
+}
+
+long mpqs(Vec<ZZ>& f, const ZZ& n)
+{
+    MPQSStats st;
+    return mpqs(f, n, MPQSParam(), st);
+}
+
+long mpqs(Vec<ZZ>& f, const ZZ& n, const MPQSParam& par, MPQSStats& st)
 // input:
 //   n = odd integer, not prime power, n>2000
 // output:
-//   d = divisor of n, 1 < d < n
+//   f = factors of n in increasing order, product of f = n
+//       split by all dependencies until every factor is prime
 //       by quadratic sieve method
+//   st = statistics
 // return:
 //   0 if successful, -1 or -2 if failure
 // reference:
 //   R. Crandall and C. Pomerance
 //     "Prime Numbers: A Computational Perspective"
 //     2nd edition (Springer) section 6.1
+//   S. P. Contini "Factoring Integers with the Self-Initializing
+//     Quadratic Sieve" (Master's thesis, University of Georgia, 1997)
 {
+    st.K = st.N = st.P = st.rows = st.cols = st.deps = st.dense = 0;
+    st.partials = st.cycles = st.k = 0;
+    st.kscore = 0;
+    st.sieve_time = st.la_time = st.sqrt_time = st.la_bytes = 0;
     if(NumBits(n) > MPQS_MAXLEN) return -1;
-    long i,j,k,l,m,p,r,s,t,K,Q,B,M,U,N,T;
-    double lnN, lnB;
+    long i,j,k,l,m,p,r,B,K,N,nb,na,wide(0);
+    double lnN, lnB, lq, t;
     static double LN2R(1./log(2));
-    ZZ a,b,c,q,u;
-    ZZ_p x,y,z;
-    Vec<long> F,S,sv,rl,FA;
-    Vec<char> LF;
+    ZZ a;
+    ZZ_p x;
+    Vec<long> c,h,od;
     vec_ZZ_p FZ,ru;
-    Mat<long> e;
-    mat_GF2 A,X;
+    Vec<Vec<MPQSRel> > rs;
+    Vec<Vec<long> > qa;
+    Vec<Vec<unsigned long> > D;// dependencies as bit vectors of rows
+    MPQSExp E;// exponent vectors of relations
+    MPQSGraph G;
+    MPQSA A;
+    MPQS Q;
+    std::unordered_set<unsigned long> us;// u or -u mod n found before
 
-    if(&d==&n) return mpqs(d,a=n);
-    lnN = log(n);
+    t = GetTime();
+    if(par.k > 0) st.k = par.k;
+    else st.k = KnuthSchroeppel(st.kscore, n);
+    mul(Q.n, n, st.k);
+    lnN = log(Q.n);
     lnB = MPQS_BOUND*sqrt(lnN*log(lnN));
     B = long(exp(lnB));
+    if(B < MPQS_MINB) B = MPQS_MINB;
 
     PrimeSeq ps;
-    F.append(ps.next());
-    S.append(1);
+    Q.F.append(ps.next());
+    Q.S.append(1);
     while((p=ps.next()) <= B) {
-        l = n%p;
-        if((j = Jacobi(l,p)) > 0) {
-            F.append(p);
-            S.append(SqrRootMod(l,p));
+        if(divide(n,p)) {
+            f.SetLength(2);
+            div(f[1],n,p);
+            conv(f[0],p);
+            return 0;
         }
-        else if(j==0) { d=p; return 0; }
+        l = rem(Q.n,p);
+        if((j = Jacobi(l,p)) < 0) continue;
+        Q.F.append(p);
+        Q.S.append(l = (j ? SqrRootMod(l,p) : 0));// 0 if p|k
+        if(l > p-l) Q.S[Q.S.length()-1] = p-l;// fix sign for determinism
     }
-    K = F.length();
-    M = long(MPQS_INTVL*B);
-    U = (M<<1)+1;
+    K = Q.K = Q.F.length();
+    Q.P = 0;
+    Q.M = long(MPQS_INTVL*B);
+    Q.U = (Q.M<<1)+1;
     N = K + MPQS_EXTRA;
     ZZ_p::init(n);
-    sv.SetLength(U);
-    LF.SetLength(K);
-    FZ.SetLength(K);
+    Q.LF.SetLength(K);
+    FZ.SetLength(K+1);
     ru.SetLength(N);
-    rl.SetLength(N);
-    e.SetDims(N,K+1);
-
-    for(i=0; i<K; i++) LF[i] = char(round(log(F[i])*LN2R));
-    for(i=0; i<K; i++) conv(FZ[i], F[i]);
-    T = long((0.5*lnN + lnB)*LN2R - MPQS_SIEV*LF[K-1]);
-    LeftShift(q,n,1);
-    SqrRoot(q,q); q/=M;
-    SqrRoot(q,q);
-    for(k=0, l=K; k<N; q++) {
-        NextPrime(q,q);
-        if((j = Jacobi(n,q)) < 0) continue;
-        else if(j==0) { d=q; return 0; }
-        sqr(a,q); rem(d,n,q);
-        SqrRootMod(b,d,q);
-        AddMod(c,b,b,q);
-        InvMod(d,c,q);
-        sqr(c,b); sub(c,n,c); c/=q;
-        MulMod(c,c,d,q);
-        MulAddTo(b,c,q);
-        RightShift(d,a,1);
-        if(b>d) sub(b,a,b);
-        sqr(c,b); c-=n; c/=a;
-        for(i=0; i<U; i++) sv[i] = 0;
-        for(j=0; j<K; j++) {
-            if(q==(p=F[j])) continue;
-            r = InvMod(a%p,p);
-            m = b%p;
-            for(t=0, s=S[j]; t<2 && p>=3; t++, s=p-s) {
-                if((i=((s-m)*r+M)%p)<0) i+=p;
-                for(; i<U; i+=p) sv[i] += LF[j];
-            }
+
+    for(i=0; i<K; i++) Q.LF[i] = char(round(log(Q.F[i])*LN2R));
+    for(i=0; i<K; i++) conv(FZ[i], Q.F[i]);
+    conv(FZ[K], -1);// large primes follow
+    Q.T = long((0.5*lnN + log(Q.M))*LN2R - MPQS_SIEV*Q.LF[K-1]);
+    for(lq=0, Q.J1=1; Q.J1<K && Q.F[Q.J1] < MPQS_SMALLP; Q.J1++)
+        lq += 2*Q.LF[Q.J1]/(Q.F[Q.J1] - 1.);
+    for(Q.J2=Q.J1; Q.J2<K && Q.F[Q.J2] < MPQS_BLOCK; Q.J2++);
+    Q.T -= long(lq + 0.5);// expected contribution of small primes
+    Q.lp = par.lp;
+    Q.L = Q.L2 = 1;
+    if(Q.lp > 0) {
+        Q.L = Q.F[K-1]*(Q.F[K-1] < MPQS_LPMUL ? Q.F[K-1] : MPQS_LPMUL);
+        Q.L2 = (Q.lp > 1 ? Q.L*Q.L : Q.L);
+        Q.T -= long(log(Q.L)*LN2R*(Q.lp > 1 ? MPQS_DLPT : MPQS_LPT));
+    }
+    vertex(G,1,FZ);
+    A.lA = 0.5*(lnN + log(2.)) - log(Q.M);// a = sqrt(2n)/M
+    lq = log(Q.F[K-1] < 2*MPQS_APRIME ? Q.F[K-1]/2 : MPQS_APRIME);
+    A.s = long(A.lA/lq + 0.5);
+    if(A.s < 1) A.s = 1;
+    lq = A.lA/A.s;// log of size of primes in a
+    for(A.lo=1; A.lo<K-1 && log(Q.F[A.lo]) < lq-MPQS_AWIN; A.lo++);
+    for(A.hi=A.lo; A.hi<K && log(Q.F[A.hi]) < lq+MPQS_AWIN; A.hi++);
+    if(A.hi - A.lo < 2*A.s + 8) { A.lo = 1; A.hi = K; }
+    A.x = 88172645463325252UL;
+    nb = AvailableThreads()*MPQS_BATCH;
+    qa.SetLength(nb);
+    rs.SetLength(nb);
+    for(k=0; k<N;) {
+        if(wide) {// all a used; double interval between batches
+            if(Q.M > MPQS_MAXM) return -1;
+            Q.M <<= 1;
+            Q.U = (Q.M<<1)+1;
+            Q.T++;
+            A.used.clear();
+            wide = 0;
         }
-        for(i=0, s=-M, r=k; i<U && k<N; i++, s++) {
-            if(sv[i] < T) continue;
-            mul(u,a,s); u+=b;
-            add(d,u,b); d*=s; d+=c;
-            if(IsZero(d)) continue;
-            for(j=0; j<=K; j++) e[k][j] = 0;
-            if(sign(d) < 0) e[k][K] = 1;
-            abs(d,d);
-            for(j=0; j<K; j++) {
-                if((p = F[j]) > d) break;
-                while(divide(d,d,p)) e[k][j]++;
+        for(na=0; na<nb; na++)// next values of a
+            if(!NextA(qa[na], A, Q)) { wide = 1; break; }
+        if(na==0) continue;
+        Q.P += na<<(A.s-1);
+        NTL_EXEC_RANGE(na, first, last)
+            Vec<unsigned char> sv;
+            Vec<Vec<unsigned int> > bk;
+            bk.SetLength((Q.U + MPQS_BLOCK-1)>>MPQS_BBITS);
+            sv.SetLength(bk.length()<<MPQS_BBITS);
+            memset(sv.elts(), 0, sv.length());
+            for(long i=first; i<last; i++) sieve(rs[i], Q, qa[i], sv, bk);
+        NTL_EXEC_RANGE_END
+        for(i=0; i<na && k<N; i++) {// merge in order of a
+            for(j=0; j<rs[i].length() && k<N; j++) {
+                const MPQSRel& R(rs[i][j]);
+                conv(x, R.u);
+                if(rep(x) > (a = n - rep(x))) a = rep(x);
+                if(!us.insert(trunc_long(a, 64)).second) continue;// duplicate
+                if(R.L[0] == 1) {// full relation
+                    ru[k] = x;
+                    append(E, h = R.e);
+                    k++;
+                    continue;
+                }
+                st.partials++;
+                G.E.SetLength((r = G.E.length()) + 1);
+                MPQSPart& P(G.E[r]);
+                P.u = x;
+                append(G.X, h = R.e);
+                P.v[0] = vertex(G, R.L[0], FZ);
+                P.v[1] = vertex(G, R.L[1], FZ);
+                if(!cycle(c,G,r)) continue;
+                st.cycles++;// combine partials in cycle
+                set(ru[k]);
+                h.SetLength(0);
+                for(r=0; r<c.length(); r++) {
+                    const MPQSPart& P(G.E[c[r]]);
+                    ru[k] *= P.u;
+                    for(m=G.X.o[c[r]]; m<G.X.o[c[r]+1]; m+=2)
+                        for(l=0; l<G.X.x[m+1]; l++) h.append(G.X.x[m]);
+                    for(m=0; m<2; m++)
+                        if(G.fz[P.v[m]] >= 0) h.append(G.fz[P.v[m]]);
+                }
+                append(E, h);// large primes have even exponents
+                k++;
             }
-            if(!IsOne(d)) continue;
-            conv(ru[k], u);
-            rl[k] = l;
-            k++;
-        }
-        if(k>r) {
-            FZ.SetLength(l+1);
-            conv(FZ[l++], q);
-        }
-    }
-    F.kill();
-    S.kill();
-    A.SetDims(N,K+1);
-    FA.SetLength(l);
-    for(i=0; i<N; i++)
-        for(j=0; j<=K; j++) if(e[i][j] & 1) set(A[i][j]);
-    kernel(X,A);
-    for(k=0; k<X.NumRows(); k++) {
-        for(i=0; i<l; i++) FA[i] = 0;
-        set(x);
-        set(y);
+        }
+    }
+    rs.kill();
+    G.E.kill();
+    G.X.x.kill();
+    G.X.o.kill();
+    Q.F.kill();
+    Q.S.kill();
+    st.K = K;
+    st.N = N;
+    st.P = Q.P;
+    st.sieve_time = GetTime() - t;
+    t = GetTime();
+    if(par.la==2 || (par.la==0 && K >= MPQS_SPARSE)) {
+        Vec<Vec<long> > A;
+        Vec<unsigned long> w;
+        A.SetLength(N);
         for(i=0; i<N; i++) {
-            if(IsZero(X[k][i])) continue;
-            x *= ru[i];
-            FA[rl[i]] += 2;
-            for(j=0; j<K; j++) FA[j] += e[i][j];
-        }
-        for(i=0; i<l; i++) {
-            if(FA[i] == 0) continue;
-            power(z, FZ[i], FA[i]>>1);
-            y *= z;
-        }
-        conv(a,x);
-        conv(b,y);
-        a -= b;
-        GCD(d,a,n);
-        if(d>1 && d<n) return 0;
-    }
-    return -2;
-}
+            for(m=E.o[i]; m<E.o[i+1]; m+=2)
+                if(E.x[m+1] & 1) A[i].append(E.x[m]);
+            st.la_bytes += 8*A[i].length();
+        }
+        if((l = BlockLanczos(w, A, K+1, &st.rows, &st.cols)) > 0) {
+            st.la_bytes += 8*8*st.rows + 8*st.cols;
+            D.SetLength(l);
+            for(j=0; j<l; j++) D[j].SetLength((N+63)>>6, 0);
+            for(i=0; i<N; i++)
+                for(j=0; j<l; j++) if(w[i]>>j & 1) D[j][i>>6] |= 1UL<<(i&63);
+        }
+    }
+    if(D.length() == 0) {
+        mat_GF2 A,X;
+        A.SetDims(N,K+1);
+        for(i=0; i<N; i++)
+            for(m=E.o[i]; m<E.o[i+1]; m+=2)
+                if(E.x[m+1] & 1) set(A[i][E.x[m]]);
+        kernel(X,A);
+        st.dense = 1;
+        st.rows = N;
+        st.cols = K+1;
+        st.la_bytes = (N + X.NumRows())*((K+64)/64)*8.;
+        D.SetLength(X.NumRows());
+        for(k=0; k<X.NumRows(); k++) {
+            D[k].SetLength((N+63)>>6);
+            for(i=0; i<D[k].length(); i++) D[k][i] = X[k].rep[i];
+        }
+    }
+    st.deps = D.length();
+    st.la_time = GetTime() - t;
+    t = GetTime();
+    od.SetLength(D.length());
+    for(k=0; k<D.length(); k++) {// try short dependencies first
+        for(i=l=0; i<D[k].length(); i++) l += __builtin_popcountl(D[k][i]);
+        od[k] = (l<<32) | k;
+    }
+    std::sort(od.elts(), od.elts() + od.length());
+    f.SetLength(1);
+    f[0] = n;
+    ZZ_pContext ctx;
+    ctx.save();
+    std::mutex mu;
+    std::atomic<long> done(0);// all factors are prime
+    NTL_EXEC_RANGE(od.length(), first, last)
+        ctx.restore();
+        long i,j,k,m;
+        unsigned long w;
+        ZZ a,b;
+        ZZ_p x,y,z;
+        Vec<long> FA;
+        FA.SetLength(FZ.length(), 0);
+        for(k=first; k<last && !done; k++) {
+            const Vec<unsigned long>& R(D[od[k] & 0xffffffff]);
+            set(x);
+            set(y);
+            for(m=0; m<R.length(); m++) {
+                for(w=R[m]; w; w&=w-1) {
+                    i = (m<<6) + __builtin_ctzl(w);
+                    x *= ru[i];
+                    for(j=E.o[i]; j<E.o[i+1]; j+=2) FA[E.x[j]] += E.x[j+1];
+                }
+            }
+            for(i=0; i<FA.length(); i++) {
+                if(FA[i] == 0) continue;
+                power(z, FZ[i], FA[i]>>1);
+                y *= z;
+                FA[i] = 0;
+            }
+            conv(a,x);
+            conv(b,y);
+            a -= b;
+            GCD(a,a,n);
+            if(IsOne(a) || a==n) continue;
+            std::lock_guard<std::mutex> g(mu);
+            if(split(f,a)) done = 1;
+        }
+    NTL_EXEC_RANGE_END
+    std::sort(f.elts(), f.elts() + f.length());
+    st.sqrt_time = GetTime() - t;
+    return (f.length() > 1 ? 0 : -2);
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+// uses NTL
+//   http://www.shoup.net/ntl
+
+#ifndef __mpqs_h__
+#define __mpqs_h__
+
+#include<NTL/ZZ.h>
+#include<NTL/vector.h>
+
+struct MPQSParam {// options for mpqs
+    long la;// linear algebra: 0=auto, 1=dense (NTL kernel), 2=block lanczos
+    long lp;// large primes per relation: 0, 1 or 2 (with cycle finding)
+    long k;// multiplier, 0=auto (Knuth-Schroeppel)
+    MPQSParam() : la(0), lp(1), k(0) {;}
+};
+
+struct MPQSStats {// statistics of one run of mpqs
+    long k;// multiplier
+    double kscore;// Knuth-Schroeppel function of k (0 if k is given)
+    long K;// number of primes in factor base
+    long N;// number of relations
+    long P;// number of polynomials sieved
+    long partials;// number of relations with large primes
+    long cycles;// number of relations combined from partials
+    long rows, cols;// dimension of matrix after filtering
+    long deps;// number of dependencies found
+    long dense;// 1 if dense linear algebra was used
+    double sieve_time, la_time, sqrt_time;// seconds
+    double la_bytes;// memory for matrix and work vectors
+};
+
+long mpqs(NTL::ZZ& d, const NTL::ZZ& n);
+long mpqs(NTL::ZZ& d, const NTL::ZZ& n, const MPQSParam& par, MPQSStats& st);
+long mpqs(NTL::Vec<NTL::ZZ>& f, const NTL::ZZ& n);
+long mpqs(NTL::Vec<NTL::ZZ>& f, const NTL::ZZ& n, const MPQSParam& par, MPQSStats& st);
+// input:
+//   n = odd integer, not prime power, n>2000
+// output:
+//   d = divisor of n, 1 < d < n
+//   f = factors of n (at least two) in increasing order, product of f = n
+//       every factor is prime unless no dependency splits it
+//       by quadratic sieve method
+//   st = statistics (if given)
+// return:
+//   0 if successful, -1 or -2 if failure
+
+long BlockLanczos(NTL::Vec<unsigned long>& z, const NTL::Vec<NTL::Vec<long> >& A, long K,
+                  long *rows=0, long *cols=0);
+// input:
+//   A = N x K matrix over GF(2)
+//       A[i] = column indices of nonzero entries in row i
+// output:
+//   z[i] = 64 dependencies of rows of A packed in bits,
+//     i.e. sum of rows i such that bit k of z[i] is set is zero
+//   rows,cols = dimension of matrix after filtering (if nonzero)
+// return:
+//   number of dependencies found (<=64), or -1 if failure
+
+#endif // __mpqs_h__
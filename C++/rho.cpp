@@ -1,30 +1,117 @@
 // uses NTL
 //   http://www.shoup.net/ntl
 
+#include<atomic>
+#include<mutex>
 #include<NTL/ZZ.h>
+#include<NTL/BasicThreadPool.h>
+#include "Mont.h"
 using namespace NTL;
 
 #define RHO_GCD_INTVL 100
+#define RHO_WORD_INTVL 1024 // gcd interval for single and double words
 
-long brent_rho(ZZ& d, const ZZ& n, double T)
+// values are multiplied by 1/R without conversion to montgomery form,
+//   since the iteration x -> x^2 + a and gcd with n do not need it
+
+static int ctz(unsigned long a) { return __builtin_ctzl(a); }// a!=0
+static int ctz(u128 a) {
+    unsigned long l(a);
+    return (l ? __builtin_ctzl(l) : 64 + __builtin_ctzl((unsigned long)(a>>64)));
+}
+
+template<class T> static T GCD_(T a, T b)
+{// binary gcd of a and b>0
+    int k;
+    if(a==0) return b;
+    k = ctz(a|b);
+    a >>= ctz(a);
+    do {
+        b >>= ctz(b);
+        if(a>b) { T t(a); a=b; b=t; }
+        b -= a;
+    } while(b);
+    return a<<k;
+}
+
+template<class M> static long brent_rho_(typename M::T& d, const M& N, double T, long R,
+                                         long a, long da, long A, const std::atomic<long>* stop)
+// d = divisor of N.n, 1 < d < N.n
+//   by A polynomials x^2 + a, x^2 + a + da, ...
+//   with cycles of length up to R
+//   until wall time T (no limit if T==0) or *stop is set (if stop!=0)
+// return 0 if successful, -1 if failure
+{
+    typedef typename M::T W;
+    W u,s,t,q,n(N.n);
+    long r,i,j;
+    for(; A>0; A--, a+=da) {
+        u=2; q=1;
+        for(r=1; r>0 && r<=R; r<<=1) {
+            s=u;
+            for(i=0; i<r; i++) u = N.add(N.mul(u,u), a);
+            for(i=j=0; i<r;) {
+                t=u;
+                j += RHO_WORD_INTVL;
+                if(j>r) j=r;
+                for(; i<j; i++) {
+                    u = N.add(N.mul(u,u), a);
+                    q = N.mul(q, N.sub(s,u));
+                }
+                if((d = GCD_<W>(q,n)) != 1) goto a;
+                if(T && GetWallTime() > T) return -1;
+                if(stop && *stop) return -1;
+            }
+        }
+        continue;
+a:      if(d<n) return 0;
+        do {
+            t = N.add(N.mul(t,t), a);
+            d = GCD_<W>(N.sub(s,t), n);
+        } while(d==1);
+        if(d<n) return 0;
+    }
+    return -1;
+}
+
+unsigned long brent_rho(unsigned long n, long R)
 // input:
-//   n = composite integer, n>=4
-//   T = timeout in seconds
-// output:
-//   d = divisor of n, 1 < d < n
-//       by Pollard rho method
+//   n = odd composite integer, n < 2^63
+//   R = max length of cycles
 // return:
-//   0 if successful, -1 if failure
-// reference:
-//   R. P. Brent "An Improved Monte Carlo Factorization Algorithm"
-//     BIT Numerical Mathematics 20 (1980) 176
+//   divisor d of n, 1 < d < n, or 0 if failure
+//       by Pollard rho method with two polynomials and bounded steps
 {
-    ZZ u(2),q,s,t;
-    long a,r,i,j;
+    unsigned long d;
+    return (brent_rho_<Mont64>(d, Mont64(n), 0, R, 1, 1, 2, 0) ? 0 : d);
+}
 
-    if(&d==&n) return brent_rho(d,s=n,T);
-    T += GetTime();
-    for(a=1;; a++) {
+static long brent_rho_(ZZ& d, const ZZ& n, double T, long a, long da,
+                       const std::atomic<long>& stop)
+// d = divisor of n, 1 < d < n
+//   by polynomials x^2 + a, x^2 + a + da, ...
+//   in single or double words if odd n < 2^127
+//   until wall time T or stop is set
+// return 0 if successful, -1 if failure
+{
+    ZZ u(2),q,s,t;
+    long r,i,j;
+    if(IsOdd(n) && NumBits(n) < 64) {
+        unsigned long e;
+        if(brent_rho_<Mont64>(e, Mont64(trunc_long(n,64)), T, 1L<<62, a, da, 1L<<62, &stop))
+            return -1;
+        conv(d,e);
+        return 0;
+    }
+    if(IsOdd(n) && NumBits(n) < 128) {
+        u128 e,m;
+        conv(m,n);
+        if(brent_rho_<Mont128>(e, Mont128(m), T, 1L<<62, a, da, 1L<<62, &stop))
+            return -1;
+        conv(d,e);
+        return 0;
+    }
+    for(;; a+=da) {
         set(q);
         for(r=1; r>0; r<<=1) {
             s=u;
@@ -44,7 +131,7 @@ long brent_rho(ZZ& d, const ZZ& n, double T)
                 }
                 GCD(d,q,n);
                 if(!IsOne(d)) goto a;
-                if(GetTime() > T) return -1;
+                if(GetWallTime() > T || stop) return -1;
             }
         }
 a:      ;
@@ -58,3 +145,39 @@ a:      ;
         if(d<n) return 0;
     }
 }
+
+long brent_rho(ZZ& d, const ZZ& n, double T)
+// input:
+//   n = composite integer, n>=4
+//   T = timeout in seconds of wall time
+// output:
+//   d = divisor of n, 1 < d < n
+//       by Pollard rho method
+//       in single or double words if odd n < 2^127
+//       with different polynomials in parallel threads
+//       (the first divisor found stops all threads)
+// return:
+//   0 if successful, -1 if failure
+// reference:
+//   R. P. Brent "An Improved Monte Carlo Factorization Algorithm"
+//     BIT Numerical Mathematics 20 (1980) 176
+//   P. L. Montgomery "Modular Multiplication Without Trial Division"
+//     Mathematics of Computation 44 (1985) 519
+{
+    ZZ m;
+    if(&d==&n) return brent_rho(d,m=n,T);
+    long P(AvailableThreads());
+    std::atomic<long> done(0);
+    std::mutex mu;
+    T += GetWallTime();// budget of all threads
+    if(P==1) return brent_rho_(d,n,T,1,1,done);
+    NTL_EXEC_INDEX(P, w)
+        ZZ e;
+        if(brent_rho_(e,n,T,w+1,P,done) == 0) {
+            std::lock_guard<std::mutex> lk(mu);
+            if(!done) d = e;
+            done = 1;
+        }
+    NTL_EXEC_INDEX_END
+    return (done ? 0 : -1);
+}